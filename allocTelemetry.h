@@ -0,0 +1,260 @@
+/**
+ * @brief Opt-in allocation telemetry for rawVector and StackPtr
+ *
+ * Define _USE_ALLOC_TELEMETRY (in every translation unit, e.g. with -D_USE_ALLOC_TELEMETRY) to count
+ * allocations, reallocations and live/peak bytes of rawVector per element type and how often
+ * StackPtr falls back from its inline buffer to the heap. Without the define nothing is recorded
+ * and rawVector and StackPtr contain no extra code.
+ *
+ * Licence: Released to the PUBLIC DOMAIN
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY OF ANY
+ * KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+ * PARTICULAR PURPOSE.
+ */
+#ifndef _ALLOCTELEMETRY_H_
+#define _ALLOCTELEMETRY_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <string>
+#include <typeinfo>
+#if defined(__GNUC__) || defined(__clang__)
+#include <cxxabi.h> // for abi::__cxa_demangle
+#endif
+
+namespace Sys
+{
+	namespace Array
+	{
+		/**
+		 * Snapshot of the counters of one container type
+		 * rawVector<T>:         allocations/reallocations/frees of memory blocks, maxRequest = largest block in bytes
+		 * StackPtr<T,maxStack>: allocations = number of StackPtr objects, spills = number of heap fallbacks,
+		 *                       maxRequest = largest requested number of elements (compare with "inlineSize" = maxStack)
+		 * bytesLive and bytesPeak count heap bytes (rawVector blocks, StackPtr spills).
+		 */
+		struct allocStats
+		{
+			std::string container;
+			std::string typeName;
+			size_t inlineSize;
+			unsigned long long allocations;
+			unsigned long long reallocations;
+			unsigned long long spills;
+			unsigned long long frees;
+			unsigned long long bytesLive;
+			unsigned long long bytesPeak;
+			unsigned long long maxRequest;
+		};
+
+		/**
+		 * Counters of one container type, created on first use and kept in a global list.
+		 * The records and the mutex of the list are never destroyed, so containers freed by static destructors
+		 * and reports from static destructors or atexit handlers still find valid objects.
+		 */
+		class allocRecord
+		{
+		public:
+			allocRecord(const char *container, const char *typeName, size_t inlineSize)
+			{
+				this->container = container;
+				this->typeName = typeName;
+				this->inlineSize = inlineSize;
+				bytesLive = 0;
+				reset();
+				std::lock_guard<std::mutex> lock(getMutex());
+				next = getList();
+				getList() = this;
+			}
+			/**
+			 * Records the allocation of a heap block
+			 */
+			inline void onAllocate(size_t bytes)
+			{
+				allocations.fetch_add(1, std::memory_order_relaxed);
+				addLive(bytes);
+				updateMax(maxRequest, bytes);
+			}
+			/**
+			 * Records that a block was replaced by a bigger or smaller one (the new block is recorded with onAllocate)
+			 */
+			inline void onReallocate()
+			{
+				reallocations.fetch_add(1, std::memory_order_relaxed);
+			}
+			/**
+			 * Records that a block was freed
+			 */
+			inline void onFree(size_t bytes)
+			{
+				frees.fetch_add(1, std::memory_order_relaxed);
+				bytesLive.fetch_sub(bytes, std::memory_order_relaxed);
+			}
+			/**
+			 * Records the construction of a StackPtr for the declared number of elements
+			 */
+			inline void onStackPtr(size_t size, size_t bytes, bool spill)
+			{
+				allocations.fetch_add(1, std::memory_order_relaxed);
+				updateMax(maxRequest, size);
+				if (spill)
+				{
+					spills.fetch_add(1, std::memory_order_relaxed);
+					addLive(bytes);
+				}
+			}
+			/**
+			 * Sets the counters to zero, the live bytes are kept (they are still allocated)
+			 */
+			void reset()
+			{
+				allocations = 0;
+				reallocations = 0;
+				spills = 0;
+				frees = 0;
+				bytesPeak = bytesLive.load();
+				maxRequest = 0;
+			}
+			allocStats getStats() const
+			{
+				allocStats stats;
+				stats.container = container;
+				stats.typeName = demangle(typeName);
+				stats.inlineSize = inlineSize;
+				stats.allocations = allocations.load(std::memory_order_relaxed);
+				stats.reallocations = reallocations.load(std::memory_order_relaxed);
+				stats.spills = spills.load(std::memory_order_relaxed);
+				stats.frees = frees.load(std::memory_order_relaxed);
+				stats.bytesLive = bytesLive.load(std::memory_order_relaxed);
+				stats.bytesPeak = bytesPeak.load(std::memory_order_relaxed);
+				stats.maxRequest = maxRequest.load(std::memory_order_relaxed);
+				return stats;
+			}
+			inline allocRecord* getNext() const
+			{
+				return next;
+			}
+			static allocRecord*& getList()
+			{
+				static allocRecord *head = NULL;
+				return head;
+			}
+			static std::mutex& getMutex()
+			{
+				static std::mutex &mutex = *new std::mutex();
+				return mutex;
+			}
+		private:
+			//disallow copy and assign
+			allocRecord(const allocRecord&);
+			void operator=(const allocRecord&);
+
+			inline void addLive(size_t bytes)
+			{
+				unsigned long long live = bytesLive.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+				updateMax(bytesPeak, live);
+			}
+			static inline void updateMax(std::atomic<unsigned long long> &value, unsigned long long newValue)
+			{
+				unsigned long long old = value.load(std::memory_order_relaxed);
+				while ((newValue > old) && !value.compare_exchange_weak(old, newValue, std::memory_order_relaxed))
+				{
+				}
+			}
+			static std::string demangle(const char *name)
+			{
+#if defined(__GNUC__) || defined(__clang__)
+				int status = 0;
+				char *res = abi::__cxa_demangle(name, NULL, NULL, &status);
+				if (res)
+				{
+					std::string str(res);
+					free(res);
+					return str;
+				}
+#endif
+				return name;
+			}
+
+			const char *container;
+			const char *typeName;
+			size_t inlineSize;
+			std::atomic<unsigned long long> allocations, reallocations, spills, frees;
+			std::atomic<unsigned long long> bytesLive, bytesPeak, maxRequest;
+			allocRecord *next;
+		};
+
+		//keys of the records
+		struct rawVectorTag {};
+		template<size_t maxStack> struct stackPtrTag {};
+
+		/**
+		 * Returns the counters for the declared key type (one record per key type)
+		 * @param *container		- name of the container, e.g. "rawVector"
+		 * @param inlineSize		- maxStack of StackPtr, otherwise 0
+		 */
+		template<class Key, class T> inline allocRecord& getAllocRecord(const char *container, size_t inlineSize)
+		{
+			static allocRecord &record = *new allocRecord(container, typeid(T).name(), inlineSize);
+			return record;
+		}
+
+		/**
+		 * Returns a snapshot of the counters of all container types which were used so far
+		 * @return vector of allocStats
+		 */
+		inline std::vector<allocStats> getAllocStats()
+		{
+			std::vector<allocStats> res;
+			std::lock_guard<std::mutex> lock(allocRecord::getMutex());
+			for (allocRecord *rec = allocRecord::getList(); rec; rec = rec->getNext())
+			{
+				res.push_back(rec->getStats());
+			}
+			return res;
+		}
+		/**
+		 * Sets all counters to zero, e.g. after a warm-up phase (live bytes are kept, the peak starts at the live bytes)
+		 */
+		inline void resetAllocStats()
+		{
+			std::lock_guard<std::mutex> lock(allocRecord::getMutex());
+			for (allocRecord *rec = allocRecord::getList(); rec; rec = rec->getNext())
+			{
+				rec->reset();
+			}
+		}
+		/**
+		 * Writes a table of all counters to the declared stream
+		 * @param *out				- e.g. stderr or a file opened with fopen
+		 */
+		inline void dumpAllocStats(FILE *out = stderr)
+		{
+			std::vector<allocStats> stats = getAllocStats();
+			fprintf(out, "%-28s %10s %10s %10s %14s %14s %12s\n", "container", "allocs", "reallocs", "frees", "live bytes", "peak bytes", "max request");
+			for (size_t i = 0; i < stats.size(); i++)
+			{
+				const allocStats &s = stats[i];
+				std::string name = s.container + "<" + s.typeName;
+				if (s.inlineSize)
+				{
+					name += ", " + std::to_string((unsigned long long)s.inlineSize);
+				}
+				name += ">";
+				fprintf(out, "%-28s %10llu %10llu %10llu %14llu %14llu %12llu", name.c_str(), s.allocations, s.reallocations, s.frees, s.bytesLive, s.bytesPeak, s.maxRequest);
+				if (s.inlineSize)
+				{
+					fprintf(out, "  spills %llu (%.1f%%)", s.spills, s.allocations ? 100.0 * s.spills / s.allocations : 0.0);
+				}
+				fprintf(out, "\n");
+			}
+		}
+	}
+}
+#endif
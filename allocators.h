@@ -0,0 +1,352 @@
+/**
+ * @brief Memory allocators for rawVector
+ *
+ * heap allocator, monotonic arena and size class pool
+ *
+ * Licence: Released to the PUBLIC DOMAIN
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY OF ANY
+ * KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+ * PARTICULAR PURPOSE.
+ */
+#ifndef _ALLOCATORS_H_
+#define _ALLOCATORS_H_
+#include <stdlib.h>
+#include <stddef.h>
+#include <new>
+#ifdef _MSC_VER
+#include <malloc.h> // for _aligned_malloc
+#endif
+
+/*
+ * An allocator which can be used with rawVector must provide:
+ *   void* allocate(size_t bytes, size_t alignment);              - throws std::bad_alloc if allocation fails
+ *   void deallocate(void *ptr, size_t bytes, size_t alignment);  - called with the same size and alignment
+ * The allocator object is stored inside of each rawVector and copied with it,
+ * so stateful allocators should only hold a pointer to the shared resource.
+ */
+namespace Sys
+{
+	namespace Array
+	{
+		/**
+		 * Allocates aligned memory on the heap
+		 * @param bytes				- number of bytes (0 is allowed)
+		 * @param alignment			- power of 2
+	     * @throw std::bad_alloc	- if memory allocation fails
+		 * @return pointer to the memory block
+		 */
+		inline void* alignedAlloc(size_t bytes, size_t alignment)
+		{
+			void *ptr = NULL;
+			if (alignment < sizeof(void*))
+			{
+				alignment = sizeof(void*);
+			}
+			if (bytes == 0)
+			{
+				bytes = 1; //make sure a valid pointer is returned
+			}
+#ifdef _MSC_VER
+			ptr = _aligned_malloc(bytes, alignment);
+#else
+			if (posix_memalign(&ptr, alignment, bytes) != 0)
+			{
+				ptr = NULL;
+			}
+#endif
+			if (ptr == NULL)
+			{
+				throw std::bad_alloc();
+			}
+			return ptr;
+		}
+		/**
+		 * Frees memory which was allocated with alignedAlloc
+		 */
+		inline void alignedFree(void *ptr)
+		{
+#ifdef _MSC_VER
+			_aligned_free(ptr);
+#else
+			free(ptr);
+#endif
+		}
+
+		/**
+		 * Power of 2 size classes (64 bytes ... 1 MB) of poolResource and StackPtrCache
+		 */
+		struct sizeClasses
+		{
+			static const size_t MINSIZE = 64;
+			static const size_t MAXSIZE = 1024 * 1024;
+			static const int COUNT = 15; //64 ... 1 MB
+
+			/**
+			 * Returns the index of the smallest size class which can hold the declared number of bytes (<= MAXSIZE)
+			 */
+			static inline int index(size_t bytes)
+			{
+				int cls = 0;
+				size_t size = MINSIZE;
+				while (size < bytes)
+				{
+					size <<= 1;
+					cls++;
+				}
+				return cls;
+			}
+			/**
+			 * Returns the size in bytes of the blocks of a size class
+			 */
+			static inline size_t size(int cls)
+			{
+				return MINSIZE << cls;
+			}
+		};
+
+		/**
+		 * Default allocator of rawVector, uses the aligned heap
+		 */
+		class heapAllocator
+		{
+		public:
+			inline void* allocate(size_t bytes, size_t alignment)
+			{
+				return alignedAlloc(bytes, alignment);
+			}
+			inline void deallocate(void *ptr, size_t, size_t)
+			{
+				alignedFree(ptr);
+			}
+		};
+
+		/**
+		 * Monotonic arena: allocations bump a pointer inside of large chunks and are freed all at once with release().
+		 * Freeing single blocks does nothing, except for the most recent allocation which is given back
+		 * (e.g. a temporary buffer freed before the next allocation). Arrays which grow in the arena leave their old
+		 * blocks behind, because the new block is allocated before the old one is freed.
+		 * Not thread safe, use one arena per thread or request.
+		 */
+		class monotonicArena
+		{
+		public:
+			/**
+			 * Creates an empty arena, memory is allocated on first use
+			 * @param chunkSize	- size of the chunks requested from the heap
+			 */
+			explicit monotonicArena(size_t chunkSize = 1024 * 1024)
+			{
+				this->chunkSize = chunkSize;
+				chunks = NULL;
+				current = NULL;
+				end = NULL;
+				lastBlock = NULL;
+			}
+			/**
+			 * Frees all memory of the arena
+			 */
+			~monotonicArena()
+			{
+				release();
+			}
+			/**
+			 * Allocates a block inside of the current chunk, a new chunk is started if the block does not fit
+			 * @throw std::bad_alloc	- if memory allocation fails
+			 */
+			void* allocate(size_t bytes, size_t alignment)
+			{
+				char *ptr = alignUp(current, alignment);
+				if ((current == NULL) || (ptr + bytes > end) || (ptr + bytes < ptr))
+				{
+					//start new chunk, big requests get a chunk of their own size
+					size_t size = bytes + alignment + sizeof(chunkHeader);
+					if (size < chunkSize)
+					{
+						size = chunkSize;
+					}
+					chunkHeader *chunk = (chunkHeader*)alignedAlloc(size, 64);
+					chunk->next = chunks;
+					chunks = chunk;
+					current = (char*)(chunk + 1);
+					end = (char*)chunk + size;
+					ptr = alignUp(current, alignment);
+				}
+				current = ptr + bytes;
+				lastBlock = ptr;
+				return ptr;
+			}
+			/**
+			 * Gives the block back if it was the last allocation, otherwise nothing is done
+			 */
+			void deallocate(void *ptr, size_t bytes, size_t)
+			{
+				if ((ptr != NULL) && (ptr == lastBlock) && ((char*)ptr + bytes == current))
+				{
+					current = (char*)ptr;
+					lastBlock = NULL;
+				}
+			}
+			/**
+			 * Frees all chunks at once. All memory allocated from the arena becomes invalid.
+			 */
+			void release()
+			{
+				while (chunks)
+				{
+					chunkHeader *next = chunks->next;
+					alignedFree(chunks);
+					chunks = next;
+				}
+				current = NULL;
+				end = NULL;
+				lastBlock = NULL;
+			}
+		private:
+			//disallow copy and assign
+			monotonicArena(const monotonicArena&);
+			void operator=(const monotonicArena&);
+
+			struct chunkHeader
+			{
+				chunkHeader *next;
+				char padding[64 - sizeof(chunkHeader*)]; //keeps the payload 64 byte aligned
+			};
+			static inline char* alignUp(char *ptr, size_t alignment)
+			{
+				return (char*)(((size_t)ptr + alignment - 1) & ~(alignment - 1));
+			}
+
+			size_t chunkSize;
+			chunkHeader *chunks;
+			char *current, *end, *lastBlock;
+		};
+
+		/**
+		 * Pool with power of 2 size classes (64 bytes ... MAXCLASS bytes).
+		 * Freed blocks are kept in a free list of their class and reused, the memory is carved from large chunks
+		 * and given back to the heap all at once with release() or in the destructor.
+		 * Bigger blocks and alignments above 64 bytes are passed to the heap.
+		 * Not thread safe, use one pool per thread or request.
+		 */
+		class poolResource
+		{
+		public:
+			static const size_t MINCLASS = sizeClasses::MINSIZE;
+			static const size_t MAXCLASS = sizeClasses::MAXSIZE;
+			static const int NUMCLASSES = sizeClasses::COUNT;
+
+			/**
+			 * Creates an empty pool, memory is allocated on first use
+			 * @param chunkSize	- size of the chunks requested from the heap (at least MAXCLASS)
+			 */
+			explicit poolResource(size_t chunkSize = 4 * 1024 * 1024) : arena((chunkSize < MAXCLASS) ? MAXCLASS : chunkSize)
+			{
+				for (int i = 0; i < NUMCLASSES; i++)
+				{
+					freeList[i] = NULL;
+				}
+			}
+			/**
+			 * Takes a block from the free list of the size class or carves a new one from the current chunk
+			 * @throw std::bad_alloc	- if memory allocation fails
+			 */
+			void* allocate(size_t bytes, size_t alignment)
+			{
+				if ((bytes > MAXCLASS) || (alignment > MINCLASS))
+				{
+					return alignedAlloc(bytes, alignment);
+				}
+				int cls = sizeClasses::index(bytes);
+				freeBlock *block = freeList[cls];
+				if (block)
+				{
+					freeList[cls] = block->next;
+					return block;
+				}
+				return arena.allocate(sizeClasses::size(cls), MINCLASS);
+			}
+			/**
+			 * Puts the block into the free list of its size class
+			 */
+			void deallocate(void *ptr, size_t bytes, size_t alignment)
+			{
+				if (ptr == NULL)
+				{
+					return;
+				}
+				if ((bytes > MAXCLASS) || (alignment > MINCLASS))
+				{
+					alignedFree(ptr);
+					return;
+				}
+				int cls = sizeClasses::index(bytes);
+				freeBlock *block = (freeBlock*)ptr;
+				block->next = freeList[cls];
+				freeList[cls] = block;
+			}
+			/**
+			 * Frees all chunks at once. All memory allocated from the pool (except big blocks) becomes invalid.
+			 */
+			void release()
+			{
+				arena.release();
+				for (int i = 0; i < NUMCLASSES; i++)
+				{
+					freeList[i] = NULL;
+				}
+			}
+		private:
+			//disallow copy and assign
+			poolResource(const poolResource&);
+			void operator=(const poolResource&);
+
+			struct freeBlock
+			{
+				freeBlock *next;
+			};
+			monotonicArena arena;
+			freeBlock *freeList[NUMCLASSES];
+		};
+
+		/**
+		 * rawVector allocator which takes its memory from a monotonicArena
+		 */
+		class arenaAllocator
+		{
+		public:
+			arenaAllocator(monotonicArena &arena) : arena(&arena) {}
+			inline void* allocate(size_t bytes, size_t alignment)
+			{
+				return arena->allocate(bytes, alignment);
+			}
+			inline void deallocate(void *ptr, size_t bytes, size_t alignment)
+			{
+				arena->deallocate(ptr, bytes, alignment);
+			}
+		private:
+			monotonicArena *arena;
+		};
+
+		/**
+		 * rawVector allocator which takes its memory from a poolResource
+		 */
+		class poolAllocator
+		{
+		public:
+			poolAllocator(poolResource &pool) : pool(&pool) {}
+			inline void* allocate(size_t bytes, size_t alignment)
+			{
+				return pool->allocate(bytes, alignment);
+			}
+			inline void deallocate(void *ptr, size_t bytes, size_t alignment)
+			{
+				pool->deallocate(ptr, bytes, alignment);
+			}
+		private:
+			poolResource *pool;
+		};
+	}
+}
+#endif
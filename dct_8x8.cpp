@@ -1,217 +1,1062 @@
-#include <Windows.h>
-#include <iostream>
-
-const float K = 0.125; // use factor 1.0/8 instead of  1.0 /sqrt(8) so we do not need to multiply it when doing IDCT
-
-static const float a1 = 1.3870398453221475f;
-static const float a2 = 1.3065629648763766f;
-static const float b1 = 1.1758756024193588f;
-static const float b2 = 0.54119610014619712f;
-static const float c1 = 0.78569495838710224f;
-static const float d1 = 0.27589937928294311f;
-
-//Sadly these constants are needed for optimization, because VC++ 2010 is to silly to do the optimization by itself... 
-static const float _a1 = 1.3870398453221475f  * K;
-static const float _a2 = 1.3065629648763766f  * K;
-static const float _b1 = 1.1758756024193588f  * K;
-static const float _b2 = 0.54119610014619712f * K;
-static const float _c1 = 0.78569495838710224f * K;
-static const float _d1 = 0.27589937928294311f * K;
-
-//DCT transformation
-//  1.00,  1.00,  1.00,  1.00,  1.00,  1.00,  1.00,  1.00  
-//    a1,    b1,    c1,    d1,   -d1,   -c1,   -b1,   -a1  
-//    a2,    b2,   -b2,   -a2,   -a2,   -b2,    b2,    a2  
-//    b1,   -d1,   -a1,   -c1,    c1,    a1,    d1,   -b1  
-//  1.00, -1.00, -1.00,  1.00,  1.00, -1.00, -1.00,  1.00  
-//    c1,   -a1,    d1,    b1,   -b1,   -d1,    a1,   -c1  
-//    b2,   -a2,    a2,   -b2,   -b2,    a2,   -a2,    b2  
-//    d1,   -c1,    b1,   -a1,    a1,   -b1,    c1,   -d1  
-
-//DCT inverse transformation
-//  1.00,    a1,    a2,    b1,  1.00,    c1,    b2,    d1  
-//  1.00,    b1,    b2,   -d1, -1.00,   -a1,   -a2,   -c1  
-//  1.00,    c1,   -b2,   -a1, -1.00,    d1,    a2,    b1  
-//  1.00,    d1,   -a2,   -c1,  1.00,    b1,   -b2,   -a1  
-//  1.00,   -d1,   -a2,    c1,  1.00,   -b1,   -b2,    a1  
-//  1.00,   -c1,   -b2,    a1, -1.00,   -d1,    a2,   -b1  
-//  1.00,   -b1,    b2,    d1, -1.00,    a1,   -a2,    c1  
-//  1.00,   -a1,    a2,   -b1,  1.00,   -c1,    b2,   -d1 
-
-
-// Performs a horizontal one dimensional DCT transformation of block size 8 
-void TransformRow(float** arr, int y)
-{
-	float s1 = arr[0][y] + arr[7][y];
-	float m1 = arr[0][y] - arr[7][y];
-	float s2 = arr[1][y] + arr[6][y];
-	float m2 = arr[1][y] - arr[6][y];
-	float s3 = arr[2][y] + arr[5][y];
-	float m3 = arr[2][y] - arr[5][y];
-	float s4 = arr[3][y] + arr[4][y];
-	float m4 = arr[3][y] - arr[4][y];
-
-	float ss1 = s2 + s3;
-	float mm1 = s2 - s3;
-	float ss2 = s1 + s4;
-	float mm2 = s1 - s4;
-
-	arr[0][y] = ( ss2 + ss1									) * K;
-	arr[1][y] = ( _a1 * m1 + _b1 * m2 + _c1 * m3 + _d1 * m4	);
-	arr[2][y] = ( _a2 * mm2 + b2 * mm1						);
-	arr[3][y] = ( _b1 * m1 - _d1 * m2 - _a1 * m3 - _c1 * m4	);
-	arr[4][y] = ( ss2 - ss1 								) * K;
-	arr[5][y] = ( _c1 * m1 - _a1 * m2 + _d1 * m3 + _b1 * m4	);
-	arr[6][y] = ( _b2 * mm2 - _a2 * mm1						);
-	arr[7][y] = ( _d1 * m1 - _c1 * m2 + _b1 * m3 - _a1 * m4 );
-}
-void TransformColumn(float** arr, int x)
-{
-	float s1 = arr[x][0] + arr[x][7];
-	float m1 = arr[x][0] - arr[x][7];
-	float s2 = arr[x][1] + arr[x][6];
-	float m2 = arr[x][1] - arr[x][6];
-	float s3 = arr[x][2] + arr[x][5];
-	float m3 = arr[x][2] - arr[x][5];
-	float s4 = arr[x][3] + arr[x][4];
-	float m4 = arr[x][3] - arr[x][4];
-
-	float ss1 = s2 + s3;
-	float mm1 = s2 - s3;
-	float ss2 = s1 + s4;
-	float mm2 = s1 - s4;
-
-	arr[x][0] = ( ss2 + ss1									) * K;
-	arr[x][1] = ( _a1 * m1 + _b1 * m2 + _c1 * m3 + _d1 * m4	);
-	arr[x][2] = ( _a2 * mm2 + _b2 * mm1						);
-	arr[x][3] = ( _b1 * m1 - _d1 * m2 - _a1 * m3 - _c1 * m4	);
-	arr[x][4] = ( ss2 - ss1 								) * K;
-	arr[x][5] = ( _c1 * m1 - _a1 * m2 + _d1 * m3 + _b1 * m4	);
-	arr[x][6] = ( _b2 * mm2 - _a2 * mm1						);
-	arr[x][7] = ( _d1 * m1 - _c1 * m2 + _b1 * m3 - _a1 * m4 );
-}
+/**
+ * @brief 8x8 discrete cosine transformation (DCT-II) and its inverse
+ *
+ * The butterflies in dct_8x8Kernels.inl are compiled for scalar, SSE and AVX2 code, the fastest version
+ * supported by the CPU is selected on first use. The SIMD versions transform 4 or 8 rows/columns of the block
+ * at once and transpose the block in the registers between the two passes.
+ *
+ * Licence: Released to the PUBLIC DOMAIN
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY OF ANY
+ * KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+ * PARTICULAR PURPOSE.
+ */
+#include "dct_8x8.h"
+#include <math.h>
+#include <stdexcept>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 
-void BackTransformRow(float** arr, int y)
-{
-	float s1 = a2 * arr[2][y];
-	float m1 = a2 * arr[6][y] - arr[0][y] - arr[4][y];
-	float s2 = b2 * arr[2][y];
-	float m2 = b2 * arr[6][y] + arr[0][y] + arr[4][y];
-
-	float ss1 = m2 + s1;
-	float mm1 = m2 - s1;
-	float ss2 =- s2 - m1;
-	float mm2 =  s2 - m1;
-
-	float k1 = a1 * arr[1][y] + b1 * arr[3][y] + c1 * arr[5][y] + d1 * arr[7][y];
-	float k2 = b1 * arr[1][y] - d1 * arr[3][y] - a1 * arr[5][y] - c1 * arr[7][y];
-	float k3 = c1 * arr[1][y] - a1 * arr[3][y] + d1 * arr[5][y] + b1 * arr[7][y];
-	float k4 = d1 * arr[1][y] - c1 * arr[3][y] + b1 * arr[5][y] - a1 * arr[7][y];
-
-	arr[0][y] = ss1 + k1; 
-	arr[1][y] = mm2 + k2;
-	arr[2][y] = ss2 + k3;
-	arr[3][y] = mm1 + k4;  
-	arr[4][y] = mm1 - k4;  
-	arr[5][y] = ss2 - k3;  
-	arr[6][y] = mm2 - k2; 
-	arr[7][y] = ss1 - k1;  
-}
-
-void BackTransformColumn(float** arr, int x)
-{
-	float s1 = a2 * arr[x][2];
-	float m1 = a2 * arr[x][6] - arr[x][0] - arr[x][4];
-	float s2 = b2 * arr[x][2];
-	float m2 = b2 * arr[x][6] + arr[x][0] + arr[x][4];
-
-	float ss1 = m2 + s1;
-	float mm1 = m2 - s1;
-	float ss2 =- s2 - m1;
-	float mm2 =  s2 - m1;
-
-	float k1 = a1 * arr[x][1] + b1 * arr[x][3] + c1 * arr[x][5] + d1 * arr[x][7];
-	float k2 = b1 * arr[x][1] - d1 * arr[x][3] - a1 * arr[x][5] - c1 * arr[x][7];
-	float k3 = c1 * arr[x][1] - a1 * arr[x][3] + d1 * arr[x][5] + b1 * arr[x][7];
-	float k4 = d1 * arr[x][1] - c1 * arr[x][3] + b1 * arr[x][5] - a1 * arr[x][7];
-
-	arr[x][0] = ss1 + k1; 
-	arr[x][1] = mm2 + k2;
-	arr[x][2] = ss2 + k3;
-	arr[x][3] = mm1 + k4;  
-	arr[x][4] = mm1 - k4;  
-	arr[x][5] = ss2 - k3;  
-	arr[x][6] = mm2 - k2; 
-	arr[x][7] = ss1 - k1;
-
-	/* unoptimized version
-	float t0 = arr[x][0] + a1 * arr[x][1] + a2 * arr[x][2] + b1 * arr[x][3] + arr[x][4] + c1 * arr[x][5] + b2 * arr[x][6] + d1 * arr[x][7];  
-	float t1 = arr[x][0] + b1 * arr[x][1] + b2 * arr[x][2] - d1 * arr[x][3] - arr[x][4] - a1 * arr[x][5] - a2 * arr[x][6] - c1 * arr[x][7];
-	float t2 = arr[x][0] + c1 * arr[x][1] - b2 * arr[x][2] - a1 * arr[x][3] - arr[x][4] + d1 * arr[x][5] + a2 * arr[x][6] + b1 * arr[x][7];
-	float t3 = arr[x][0] + d1 * arr[x][1] - a2 * arr[x][2] - c1 * arr[x][3] + arr[x][4] + b1 * arr[x][5] - b2 * arr[x][6] - a1 * arr[x][7];  
-	float t4 = arr[x][0] - d1 * arr[x][1] - a2 * arr[x][2] + c1 * arr[x][3] + arr[x][4] - b1 * arr[x][5] - b2 * arr[x][6] + a1 * arr[x][7];  
-	float t5 = arr[x][0] - c1 * arr[x][1] - b2 * arr[x][2] + a1 * arr[x][3] - arr[x][4] - d1 * arr[x][5] + a2 * arr[x][6] - b1 * arr[x][7];  
-	float t6 = arr[x][0] - b1 * arr[x][1] + b2 * arr[x][2] + d1 * arr[x][3] - arr[x][4] + a1 * arr[x][5] - a2 * arr[x][6] + c1 * arr[x][7]; 
-	float t7 = arr[x][0] - a1 * arr[x][1] + a2 * arr[x][2] - b1 * arr[x][3] + arr[x][4] - c1 * arr[x][5] + b2 * arr[x][6] - d1 * arr[x][7];  
-
-	arr[x][0] = t0;
-	arr[x][1] = t1;
-	arr[x][2] = t2;
-	arr[x][3] = t3;
-	arr[x][4] = t4;
-	arr[x][5] = t5;
-	arr[x][6] = t6;
-	arr[x][7] = t7;
-	*/
-}
+//clang ignores "#pragma GCC target", so the SIMD kernels are only compiled with GCC
+#if defined(__GNUC__) && !defined(__clang__) && (defined(__x86_64__) || defined(__i386__))
+#define _DCT_USE_X86
+#include <immintrin.h>
+#endif
 
+//the kernels do the same operations in the same order for every instruction set, a multiplication and an addition
+//must not be fused (e.g. with -march=native) or the versions deliver different results
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
 
-void dct(float** arr)
+namespace Sys
 {
-	for (int y = 0; y < 8; y++)
-	{
-		TransformRow(arr, y);
-	}
-	for (int x = 0; x < 8; x++)
+	namespace Math
 	{
-		TransformColumn(arr, x);
-	}
-}
+		namespace Transformation
+		{
+			namespace
+			{
+				const float K = 0.125; // use factor 1.0/8 instead of  1.0 /sqrt(8) so we do not need to multiply it when doing IDCT
 
-void idct(float** arr)
-{
-	for (int x = 0; x < 8; x++)
-	{
-		BackTransformColumn(arr, x);
-	}
-	for (int y = 0; y < 8; y++)
-	{
-		BackTransformRow(arr, y);
-	}
+				const float a1 = 1.3870398453221475f;
+				const float a2 = 1.3065629648763766f;
+				const float b1 = 1.1758756024193588f;
+				const float b2 = 0.54119610014619712f;
+				const float c1 = 0.78569495838710224f;
+				const float d1 = 0.27589937928294311f;
 
-}
+				//constants of the forward transformation with the scaling K already applied
+				const float _a1 = 1.3870398453221475f  * K;
+				const float _a2 = 1.3065629648763766f  * K;
+				const float _b1 = 1.1758756024193588f  * K;
+				const float _b2 = 0.54119610014619712f * K;
+				const float _c1 = 0.78569495838710224f * K;
+				const float _d1 = 0.27589937928294311f * K;
 
+				//constants of the fixed-point version, scaled by 2^CONST_BITS (they fit into 16 bits for pmaddwd)
+				//the first pass keeps PASS1_BITS additional bits, the coefficients have DCT_FIXED_FRACBITS fractional bits
+				const int CONST_BITS = 13;
+				const int PASS1_BITS = 1;
+				const int16_t FIX_ONE = 1 << CONST_BITS;
+				const int16_t FIX_A1 = (int16_t)(1.3870398453221475  * (1 << CONST_BITS) + 0.5);
+				const int16_t FIX_A2 = (int16_t)(1.3065629648763766  * (1 << CONST_BITS) + 0.5);
+				const int16_t FIX_B1 = (int16_t)(1.1758756024193588  * (1 << CONST_BITS) + 0.5);
+				const int16_t FIX_B2 = (int16_t)(0.54119610014619712 * (1 << CONST_BITS) + 0.5);
+				const int16_t FIX_C1 = (int16_t)(0.78569495838710224 * (1 << CONST_BITS) + 0.5);
+				const int16_t FIX_D1 = (int16_t)(0.27589937928294311 * (1 << CONST_BITS) + 0.5);
+				//shifts of the two passes, the forward transformation includes K * K * 2^DCT_FIXED_FRACBITS = 1/8
+				const int FWD_SHIFT1 = CONST_BITS - PASS1_BITS;
+				const int FWD_SHIFT2 = CONST_BITS + PASS1_BITS + 6 - DCT_FIXED_FRACBITS;
+				const int INV_SHIFT1 = CONST_BITS - PASS1_BITS;
+				const int INV_SHIFT2 = CONST_BITS + PASS1_BITS + DCT_FIXED_FRACBITS;
 
+				inline int16_t saturate(int32_t x)
+				{
+					return (int16_t)((x < -32768) ? -32768 : ((x > 32767) ? 32767 : x));
+				}
+				//rounds to nearest (even) like the SIMD conversion, the value is clamped to the range of int16_t first
+				inline int16_t quantize(float x)
+				{
+					x = (x < -32768.0f) ? -32768.0f : ((x > 32767.0f) ? 32767.0f : x);
+					return (int16_t)lrintf(x);
+				}
+				//index of the element (row, column) = (n / 8, n % 8) in the transposed block
+				inline int transposed(int n)
+				{
+					return ((n & 7) << 3) | (n >> 3);
+				}
 
+				//DCT transformation
+				//  1.00,  1.00,  1.00,  1.00,  1.00,  1.00,  1.00,  1.00
+				//    a1,    b1,    c1,    d1,   -d1,   -c1,   -b1,   -a1
+				//    a2,    b2,   -b2,   -a2,   -a2,   -b2,    b2,    a2
+				//    b1,   -d1,   -a1,   -c1,    c1,    a1,    d1,   -b1
+				//  1.00, -1.00, -1.00,  1.00,  1.00, -1.00, -1.00,  1.00
+				//    c1,   -a1,    d1,    b1,   -b1,   -d1,    a1,   -c1
+				//    b2,   -a2,    a2,   -b2,   -b2,    a2,   -a2,    b2
+				//    d1,   -c1,    b1,   -a1,    a1,   -b1,    c1,   -d1
 
+				//DCT inverse transformation
+				//  1.00,    a1,    a2,    b1,  1.00,    c1,    b2,    d1
+				//  1.00,    b1,    b2,   -d1, -1.00,   -a1,   -a2,   -c1
+				//  1.00,    c1,   -b2,   -a1, -1.00,    d1,    a2,    b1
+				//  1.00,    d1,   -a2,   -c1,  1.00,    b1,   -b2,   -a1
+				//  1.00,   -d1,   -a2,    c1,  1.00,   -b1,   -b2,    a1
+				//  1.00,   -c1,   -b2,    a1, -1.00,   -d1,    a2,   -b1
+				//  1.00,   -b1,    b2,    d1, -1.00,    a1,   -a2,    c1
+				//  1.00,   -a1,    a2,   -b1,  1.00,   -c1,    b2,   -d1
 
-/*
-void main()
-{
-	float xxx_d[64];
-	float* xxx[8];
-	for (int x=0; x < 8;x++)
-	{
-		xxx[x] = &xxx_d[x*8];
-		for(int y=0; y< 8;y++)
-		{
-			xxx[x][y]=x*y;
-		}
-	}
-	//std::cout << (GetTickCount()-start); 
+				#pragma region "scalar"
+				namespace scalar
+				{
+					struct traits
+					{
+						typedef float V;
+						static inline V set1(float v) { return v; }
+						static inline V add(V a, V b) { return a + b; }
+						static inline V sub(V a, V b) { return a - b; }
+						static inline V mul(V a, V b) { return a * b; }
+
+						//wrap around on overflow like the SIMD code
+						struct R { int16_t a, b; };
+						static inline int16_t wrap(int32_t x) { return (int16_t)(uint16_t)(uint32_t)x; }
+						static inline R addw(R x, R y) { R r = { wrap(x.a + y.a), wrap(x.b + y.b) }; return r; }
+						static inline R subw(R x, R y) { R r = { wrap(x.a - y.a), wrap(x.b - y.b) }; return r; }
+						static inline R swap(R x) { R r = { x.b, x.a }; return r; }
+						typedef R P;
+						static inline P pairLo(R x, R y) { P p = { x.a, y.a }; return p; }
+						static inline P pairHi(R x, R y) { P p = { x.b, y.b }; return p; }
+						typedef int32_t I;
+						static inline I madd(P p, int16_t c0, int16_t c1) { return addi((int32_t)p.a * c0, (int32_t)p.b * c1); }
+						static inline I set1i(int32_t v) { return v; }
+						static inline I addi(I a, I b) { return (int32_t)((uint32_t)a + (uint32_t)b); }
+						static inline I subi(I a, I b) { return (int32_t)((uint32_t)a - (uint32_t)b); }
+						static inline I srai(I a, int n) { return a >> n; }
+						static inline R packs(I x, I y) { R r = { saturate(x), saturate(y) }; return r; }
+					};
+					#include "dct_8x8Kernels.inl"
+					typedef kernels<traits> K8;
+					typedef fixedKernels<traits> F8;
+
+					void dct(float *block, ptrdiff_t stride)
+					{
+						float v[8];
+						//along the first index
+						for (int y = 0; y < 8; y++)
+						{
+							for (int i = 0; i < 8; i++)
+								v[i] = block[i * stride + y];
+							K8::transform(v);
+							for (int i = 0; i < 8; i++)
+								block[i * stride + y] = v[i];
+						}
+						//along the second index
+						for (int x = 0; x < 8; x++)
+						{
+							float *p = block + x * stride;
+							for (int i = 0; i < 8; i++)
+								v[i] = p[i];
+							K8::transform(v);
+							for (int i = 0; i < 8; i++)
+								p[i] = v[i];
+						}
+					}
+
+					void idct(float *block, ptrdiff_t stride)
+					{
+						float v[8];
+						for (int x = 0; x < 8; x++)
+						{
+							float *p = block + x * stride;
+							for (int i = 0; i < 8; i++)
+								v[i] = p[i];
+							K8::backTransform(v);
+							for (int i = 0; i < 8; i++)
+								p[i] = v[i];
+						}
+						for (int y = 0; y < 8; y++)
+						{
+							for (int i = 0; i < 8; i++)
+								v[i] = block[i * stride + y];
+							K8::backTransform(v);
+							for (int i = 0; i < 8; i++)
+								block[i * stride + y] = v[i];
+						}
+					}
+
+					//the 8 elements with distance step as pairs of rows for fixedKernels
+					inline void load(const int16_t *p, ptrdiff_t step, traits::R *r)
+					{
+						for (int i = 0; i < 4; i++)
+						{
+							r[i].a = p[(2 * i) * step];
+							r[i].b = p[(2 * i + 1) * step];
+						}
+					}
+					inline void store(int16_t *p, ptrdiff_t step, const traits::R *r)
+					{
+						for (int i = 0; i < 4; i++)
+						{
+							p[(2 * i) * step] = r[i].a;
+							p[(2 * i + 1) * step] = r[i].b;
+						}
+					}
+
+					void dctFixed(int16_t *block, ptrdiff_t stride)
+					{
+						traits::R r[4];
+						for (int y = 0; y < 8; y++)
+						{
+							load(block + y, stride, r);
+							F8::transform<FWD_SHIFT1>(r);
+							store(block + y, stride, r);
+						}
+						for (int x = 0; x < 8; x++)
+						{
+							load(block + x * stride, 1, r);
+							F8::transform<FWD_SHIFT2>(r);
+							store(block + x * stride, 1, r);
+						}
+					}
+
+					void idctFixed(int16_t *block, ptrdiff_t stride)
+					{
+						traits::R r[4];
+						for (int x = 0; x < 8; x++)
+						{
+							load(block + x * stride, 1, r);
+							F8::backTransform<INV_SHIFT1>(r);
+							store(block + x * stride, 1, r);
+						}
+						for (int y = 0; y < 8; y++)
+						{
+							load(block + y, stride, r);
+							F8::backTransform<INV_SHIFT2>(r);
+							store(block + y, stride, r);
+						}
+					}
+
+					void dctQuantize(const float *block, ptrdiff_t stride, const float *quant, int16_t *coefs)
+					{
+						float tmp[64];
+						for (int x = 0; x < 8; x++)
+						{
+							for (int y = 0; y < 8; y++)
+								tmp[x * 8 + y] = block[x * stride + y];
+						}
+						dct(tmp, 8);
+						for (int k = 0; k < 64; k++)
+						{
+							int n = dctZigzag[k];
+							coefs[k] = quantize(tmp[n] * quant[transposed(n)]);
+						}
+					}
+
+					void idctDequantize(const int16_t *coefs, const float *dequant, float *block, ptrdiff_t stride)
+					{
+						for (int k = 0; k < 64; k++)
+						{
+							int n = dctZigzag[k];
+							block[(n >> 3) * stride + (n & 7)] = (float)coefs[k] * dequant[transposed(n)];
+						}
+						idct(block, stride);
+					}
+				}
+				#pragma endregion
+
+#ifdef _DCT_USE_X86
+				#pragma region "SSE"
+				#pragma GCC push_options
+				#pragma GCC target("sse2")
+				namespace sse
+				{
+					struct traits
+					{
+						typedef __m128 V;
+						static inline V set1(float v) { return _mm_set1_ps(v); }
+						static inline V add(V a, V b) { return _mm_add_ps(a, b); }
+						static inline V sub(V a, V b) { return _mm_sub_ps(a, b); }
+						static inline V mul(V a, V b) { return _mm_mul_ps(a, b); }
+
+						//rows of 8 lanes with 16 bits, the 32 bit values of the lanes 0-3 and 4-7 are kept in lo and hi
+						struct R { __m128i a, b; };
+						static inline R addw(R x, R y) { R r = { _mm_add_epi16(x.a, y.a), _mm_add_epi16(x.b, y.b) }; return r; }
+						static inline R subw(R x, R y) { R r = { _mm_sub_epi16(x.a, y.a), _mm_sub_epi16(x.b, y.b) }; return r; }
+						static inline R swap(R x) { R r = { x.b, x.a }; return r; }
+						struct P { __m128i lo, hi; };
+						static inline P pairLo(R x, R y) { P p = { _mm_unpacklo_epi16(x.a, y.a), _mm_unpackhi_epi16(x.a, y.a) }; return p; }
+						static inline P pairHi(R x, R y) { P p = { _mm_unpacklo_epi16(x.b, y.b), _mm_unpackhi_epi16(x.b, y.b) }; return p; }
+						typedef P I;
+						static inline I madd(P p, int16_t c0, int16_t c1)
+						{
+							__m128i c = _mm_set1_epi32((int32_t)(((uint32_t)(uint16_t)c1 << 16) | (uint16_t)c0));
+							I r = { _mm_madd_epi16(p.lo, c), _mm_madd_epi16(p.hi, c) };
+							return r;
+						}
+						static inline I set1i(int32_t v) { I r = { _mm_set1_epi32(v), _mm_set1_epi32(v) }; return r; }
+						static inline I addi(I a, I b) { I r = { _mm_add_epi32(a.lo, b.lo), _mm_add_epi32(a.hi, b.hi) }; return r; }
+						static inline I subi(I a, I b) { I r = { _mm_sub_epi32(a.lo, b.lo), _mm_sub_epi32(a.hi, b.hi) }; return r; }
+						static inline I srai(I a, int n) { I r = { _mm_srai_epi32(a.lo, n), _mm_srai_epi32(a.hi, n) }; return r; }
+						static inline R packs(I x, I y) { R r = { _mm_packs_epi32(x.lo, x.hi), _mm_packs_epi32(y.lo, y.hi) }; return r; }
+					};
+					#include "dct_8x8Kernels.inl"
+					typedef kernels<traits> K8;
+					typedef fixedKernels<traits> F8;
+
+					/**
+					 * Transposes the 8x8 block, lo[i]/hi[i] hold the elements 0-3/4-7 of row i
+					 */
+					inline void transpose(__m128 *lo, __m128 *hi)
+					{
+						_MM_TRANSPOSE4_PS(lo[0], lo[1], lo[2], lo[3]);
+						_MM_TRANSPOSE4_PS(hi[0], hi[1], hi[2], hi[3]);
+						_MM_TRANSPOSE4_PS(lo[4], lo[5], lo[6], lo[7]);
+						_MM_TRANSPOSE4_PS(hi[4], hi[5], hi[6], hi[7]);
+						for (int i = 0; i < 4; i++)
+						{
+							__m128 t = hi[i];
+							hi[i] = lo[i + 4];
+							lo[i + 4] = t;
+						}
+					}
+					inline void load(const float *block, ptrdiff_t stride, __m128 *lo, __m128 *hi)
+					{
+						for (int i = 0; i < 8; i++)
+						{
+							lo[i] = _mm_loadu_ps(block + i * stride);
+							hi[i] = _mm_loadu_ps(block + i * stride + 4);
+						}
+					}
+					inline void store(float *block, ptrdiff_t stride, const __m128 *lo, const __m128 *hi)
+					{
+						for (int i = 0; i < 8; i++)
+						{
+							_mm_storeu_ps(block + i * stride, lo[i]);
+							_mm_storeu_ps(block + i * stride + 4, hi[i]);
+						}
+					}
+
+					void dct(float *block, ptrdiff_t stride)
+					{
+						__m128 lo[8], hi[8];
+						load(block, stride, lo, hi);
+						//along the first index, the lanes are the columns
+						K8::transform(lo);
+						K8::transform(hi);
+						//along the second index
+						transpose(lo, hi);
+						K8::transform(lo);
+						K8::transform(hi);
+						transpose(lo, hi);
+						store(block, stride, lo, hi);
+					}
+
+					void idct(float *block, ptrdiff_t stride)
+					{
+						__m128 lo[8], hi[8];
+						load(block, stride, lo, hi);
+						transpose(lo, hi);
+						K8::backTransform(lo);
+						K8::backTransform(hi);
+						transpose(lo, hi);
+						K8::backTransform(lo);
+						K8::backTransform(hi);
+						store(block, stride, lo, hi);
+					}
+
+					/**
+					 * Transposes the 8x8 block of 16 bit samples, r[i] holds the rows 2 * i and 2 * i + 1
+					 */
+					inline void transpose(traits::R *r)
+					{
+						__m128i t0 = _mm_unpacklo_epi16(r[0].a, r[0].b);
+						__m128i t1 = _mm_unpackhi_epi16(r[0].a, r[0].b);
+						__m128i t2 = _mm_unpacklo_epi16(r[1].a, r[1].b);
+						__m128i t3 = _mm_unpackhi_epi16(r[1].a, r[1].b);
+						__m128i t4 = _mm_unpacklo_epi16(r[2].a, r[2].b);
+						__m128i t5 = _mm_unpackhi_epi16(r[2].a, r[2].b);
+						__m128i t6 = _mm_unpacklo_epi16(r[3].a, r[3].b);
+						__m128i t7 = _mm_unpackhi_epi16(r[3].a, r[3].b);
+
+						__m128i u0 = _mm_unpacklo_epi32(t0, t2);
+						__m128i u1 = _mm_unpackhi_epi32(t0, t2);
+						__m128i u2 = _mm_unpacklo_epi32(t1, t3);
+						__m128i u3 = _mm_unpackhi_epi32(t1, t3);
+						__m128i u4 = _mm_unpacklo_epi32(t4, t6);
+						__m128i u5 = _mm_unpackhi_epi32(t4, t6);
+						__m128i u6 = _mm_unpacklo_epi32(t5, t7);
+						__m128i u7 = _mm_unpackhi_epi32(t5, t7);
+
+						r[0].a = _mm_unpacklo_epi64(u0, u4);
+						r[0].b = _mm_unpackhi_epi64(u0, u4);
+						r[1].a = _mm_unpacklo_epi64(u1, u5);
+						r[1].b = _mm_unpackhi_epi64(u1, u5);
+						r[2].a = _mm_unpacklo_epi64(u2, u6);
+						r[2].b = _mm_unpackhi_epi64(u2, u6);
+						r[3].a = _mm_unpacklo_epi64(u3, u7);
+						r[3].b = _mm_unpackhi_epi64(u3, u7);
+					}
+					inline void load(const int16_t *block, ptrdiff_t stride, traits::R *r)
+					{
+						for (int i = 0; i < 4; i++)
+						{
+							r[i].a = _mm_loadu_si128((const __m128i*)(block + (2 * i) * stride));
+							r[i].b = _mm_loadu_si128((const __m128i*)(block + (2 * i + 1) * stride));
+						}
+					}
+					inline void store(int16_t *block, ptrdiff_t stride, const traits::R *r)
+					{
+						for (int i = 0; i < 4; i++)
+						{
+							_mm_storeu_si128((__m128i*)(block + (2 * i) * stride), r[i].a);
+							_mm_storeu_si128((__m128i*)(block + (2 * i + 1) * stride), r[i].b);
+						}
+					}
+
+					void dctFixed(int16_t *block, ptrdiff_t stride)
+					{
+						traits::R v[4];
+						load(block, stride, v);
+						F8::transform<FWD_SHIFT1>(v);
+						transpose(v);
+						F8::transform<FWD_SHIFT2>(v);
+						transpose(v);
+						store(block, stride, v);
+					}
 
-	dct((float**) xxx);
-	idct((float**) xxx);
+					void idctFixed(int16_t *block, ptrdiff_t stride)
+					{
+						traits::R v[4];
+						load(block, stride, v);
+						transpose(v);
+						F8::backTransform<INV_SHIFT1>(v);
+						transpose(v);
+						F8::backTransform<INV_SHIFT2>(v);
+						store(block, stride, v);
+					}
 
-};
-*/
+					inline __m128i quantize(__m128 x, const float *quant)
+					{
+						x = _mm_mul_ps(x, _mm_loadu_ps(quant));
+						x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-32768.0f)), _mm_set1_ps(32767.0f));
+						return _mm_cvtps_epi32(x);
+					}
+
+					void dctQuantize(const float *block, ptrdiff_t stride, const float *quant, int16_t *coefs)
+					{
+						__m128 lo[8], hi[8];
+						for (int i = 0; i < 8; i++)
+						{
+							lo[i] = _mm_loadu_ps(block + i * stride);
+							hi[i] = _mm_loadu_ps(block + i * stride + 4);
+						}
+						K8::transform(lo);
+						K8::transform(hi);
+						transpose(lo, hi);
+						K8::transform(lo);
+						K8::transform(hi);
+						//the block stays transposed, the table is in the same order
+						alignas(16) int16_t tmp[64];
+						for (int i = 0; i < 8; i++)
+						{
+							_mm_store_si128((__m128i*)(tmp + i * 8), _mm_packs_epi32(quantize(lo[i], quant + i * 8), quantize(hi[i], quant + i * 8 + 4)));
+						}
+						for (int k = 0; k < 64; k++)
+						{
+							coefs[k] = tmp[transposed(dctZigzag[k])];
+						}
+					}
+
+					void idctDequantize(const int16_t *coefs, const float *dequant, float *block, ptrdiff_t stride)
+					{
+						//the coefficients are placed transposed, so the first transposition of idct is not needed
+						alignas(16) int16_t tmp[64];
+						for (int k = 0; k < 64; k++)
+						{
+							tmp[transposed(dctZigzag[k])] = coefs[k];
+						}
+						__m128 lo[8], hi[8];
+						for (int i = 0; i < 8; i++)
+						{
+							__m128i row = _mm_load_si128((const __m128i*)(tmp + i * 8));
+							lo[i] = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(row, row), 16)), _mm_loadu_ps(dequant + i * 8));
+							hi[i] = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(row, row), 16)), _mm_loadu_ps(dequant + i * 8 + 4));
+						}
+						K8::backTransform(lo);
+						K8::backTransform(hi);
+						transpose(lo, hi);
+						K8::backTransform(lo);
+						K8::backTransform(hi);
+						for (int i = 0; i < 8; i++)
+						{
+							_mm_storeu_ps(block + i * stride, lo[i]);
+							_mm_storeu_ps(block + i * stride + 4, hi[i]);
+						}
+					}
+				}
+				#pragma GCC pop_options
+				#pragma endregion
+
+				#pragma region "AVX2"
+				#pragma GCC push_options
+				#pragma GCC target("avx2")
+				namespace avx2
+				{
+					struct traits
+					{
+						typedef __m256 V;
+						static inline V set1(float v) { return _mm256_set1_ps(v); }
+						static inline V add(V a, V b) { return _mm256_add_ps(a, b); }
+						static inline V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+						static inline V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+
+						//two rows a, b of 16 bits in the 16 lanes as packs_epi32 delivers them: a0-3 b0-3 | a4-7 b4-7
+						typedef __m256i R;
+						static inline R addw(R x, R y) { return _mm256_add_epi16(x, y); }
+						static inline R subw(R x, R y) { return _mm256_sub_epi16(x, y); }
+						static inline R swap(R x) { return _mm256_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)); }
+						typedef __m256i P;
+						static inline P pairLo(R x, R y) { return _mm256_unpacklo_epi16(x, y); }
+						static inline P pairHi(R x, R y) { return _mm256_unpackhi_epi16(x, y); }
+						typedef __m256i I;
+						static inline I madd(P p, int16_t c0, int16_t c1) { return _mm256_madd_epi16(p, _mm256_set1_epi32((int32_t)(((uint32_t)(uint16_t)c1 << 16) | (uint16_t)c0))); }
+						static inline I set1i(int32_t v) { return _mm256_set1_epi32(v); }
+						static inline I addi(I a, I b) { return _mm256_add_epi32(a, b); }
+						static inline I subi(I a, I b) { return _mm256_sub_epi32(a, b); }
+						static inline I srai(I a, int n) { return _mm256_srai_epi32(a, n); }
+						static inline R packs(I x, I y) { return _mm256_packs_epi32(x, y); }
+					};
+					#include "dct_8x8Kernels.inl"
+					typedef kernels<traits> K8;
+					typedef fixedKernels<traits> F8;
+
+					/**
+					 * Transposes the 8x8 block, v[i] holds row i
+					 */
+					inline void transpose(__m256 *v)
+					{
+						__m256 t0 = _mm256_unpacklo_ps(v[0], v[1]);
+						__m256 t1 = _mm256_unpackhi_ps(v[0], v[1]);
+						__m256 t2 = _mm256_unpacklo_ps(v[2], v[3]);
+						__m256 t3 = _mm256_unpackhi_ps(v[2], v[3]);
+						__m256 t4 = _mm256_unpacklo_ps(v[4], v[5]);
+						__m256 t5 = _mm256_unpackhi_ps(v[4], v[5]);
+						__m256 t6 = _mm256_unpacklo_ps(v[6], v[7]);
+						__m256 t7 = _mm256_unpackhi_ps(v[6], v[7]);
+
+						__m256 u0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+						__m256 u1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+						__m256 u2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+						__m256 u3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+						__m256 u4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+						__m256 u5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+						__m256 u6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+						__m256 u7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+						v[0] = _mm256_permute2f128_ps(u0, u4, 0x20);
+						v[1] = _mm256_permute2f128_ps(u1, u5, 0x20);
+						v[2] = _mm256_permute2f128_ps(u2, u6, 0x20);
+						v[3] = _mm256_permute2f128_ps(u3, u7, 0x20);
+						v[4] = _mm256_permute2f128_ps(u0, u4, 0x31);
+						v[5] = _mm256_permute2f128_ps(u1, u5, 0x31);
+						v[6] = _mm256_permute2f128_ps(u2, u6, 0x31);
+						v[7] = _mm256_permute2f128_ps(u3, u7, 0x31);
+					}
+
+					void dct(float *block, ptrdiff_t stride)
+					{
+						__m256 v[8];
+						for (int i = 0; i < 8; i++)
+							v[i] = _mm256_loadu_ps(block + i * stride);
+						//along the first index, the lanes are the columns
+						K8::transform(v);
+						//along the second index
+						transpose(v);
+						K8::transform(v);
+						transpose(v);
+						for (int i = 0; i < 8; i++)
+							_mm256_storeu_ps(block + i * stride, v[i]);
+					}
+
+					void idct(float *block, ptrdiff_t stride)
+					{
+						__m256 v[8];
+						for (int i = 0; i < 8; i++)
+							v[i] = _mm256_loadu_ps(block + i * stride);
+						transpose(v);
+						K8::backTransform(v);
+						transpose(v);
+						K8::backTransform(v);
+						for (int i = 0; i < 8; i++)
+							_mm256_storeu_ps(block + i * stride, v[i]);
+					}
+
+					/**
+					 * Transposes the 8x8 block of 16 bit samples, r[i] holds the rows 2 * i and 2 * i + 1 (see traits::R)
+					 */
+					inline void transpose(__m256i *r)
+					{
+						//columns 0-3 and 4-7 of the rows 0-3 | 4-7
+						__m256i y0 = _mm256_permute2x128_si256(r[0], r[2], 0x20);
+						__m256i y1 = _mm256_permute2x128_si256(r[1], r[3], 0x20);
+						__m256i y2 = _mm256_permute2x128_si256(r[0], r[2], 0x31);
+						__m256i y3 = _mm256_permute2x128_si256(r[1], r[3], 0x31);
+						//4x4 transpositions inside of the 128 bit lanes
+						__m256i t0 = _mm256_unpacklo_epi16(y0, y1);
+						__m256i t1 = _mm256_unpackhi_epi16(y0, y1);
+						__m256i t2 = _mm256_unpacklo_epi16(y2, y3);
+						__m256i t3 = _mm256_unpackhi_epi16(y2, y3);
+						r[0] = _mm256_unpacklo_epi16(t0, t1);
+						r[1] = _mm256_unpackhi_epi16(t0, t1);
+						r[2] = _mm256_unpacklo_epi16(t2, t3);
+						r[3] = _mm256_unpackhi_epi16(t2, t3);
+					}
+					inline void load(const int16_t *block, ptrdiff_t stride, __m256i *r)
+					{
+						for (int i = 0; i < 4; i++)
+						{
+							__m256i rows = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(block + (2 * i) * stride))),
+								_mm_loadu_si128((const __m128i*)(block + (2 * i + 1) * stride)), 1);
+							r[i] = _mm256_permute4x64_epi64(rows, _MM_SHUFFLE(3, 1, 2, 0));
+						}
+					}
+					inline void store(int16_t *block, ptrdiff_t stride, const __m256i *r)
+					{
+						for (int i = 0; i < 4; i++)
+						{
+							__m256i rows = _mm256_permute4x64_epi64(r[i], _MM_SHUFFLE(3, 1, 2, 0));
+							_mm_storeu_si128((__m128i*)(block + (2 * i) * stride), _mm256_castsi256_si128(rows));
+							_mm_storeu_si128((__m128i*)(block + (2 * i + 1) * stride), _mm256_extracti128_si256(rows, 1));
+						}
+					}
+
+					void dctFixed(int16_t *block, ptrdiff_t stride)
+					{
+						__m256i r[4];
+						load(block, stride, r);
+						F8::transform<FWD_SHIFT1>(r);
+						transpose(r);
+						F8::transform<FWD_SHIFT2>(r);
+						transpose(r);
+						store(block, stride, r);
+					}
+
+					void idctFixed(int16_t *block, ptrdiff_t stride)
+					{
+						__m256i r[4];
+						load(block, stride, r);
+						transpose(r);
+						F8::backTransform<INV_SHIFT1>(r);
+						transpose(r);
+						F8::backTransform<INV_SHIFT2>(r);
+						store(block, stride, r);
+					}
+
+					inline __m256i quantize(__m256 x, const float *quant)
+					{
+						x = _mm256_mul_ps(x, _mm256_loadu_ps(quant));
+						x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(-32768.0f)), _mm256_set1_ps(32767.0f));
+						return _mm256_cvtps_epi32(x);
+					}
+
+					void dctQuantize(const float *block, ptrdiff_t stride, const float *quant, int16_t *coefs)
+					{
+						__m256 v[8];
+						for (int i = 0; i < 8; i++)
+							v[i] = _mm256_loadu_ps(block + i * stride);
+						K8::transform(v);
+						transpose(v);
+						K8::transform(v);
+						//the block stays transposed, the table is in the same order
+						alignas(32) int16_t tmp[64];
+						for (int i = 0; i < 8; i += 2)
+						{
+							__m256i rows = _mm256_packs_epi32(quantize(v[i], quant + i * 8), quantize(v[i + 1], quant + (i + 1) * 8));
+							_mm256_store_si256((__m256i*)(tmp + i * 8), _mm256_permute4x64_epi64(rows, _MM_SHUFFLE(3, 1, 2, 0)));
+						}
+						for (int k = 0; k < 64; k++)
+						{
+							coefs[k] = tmp[transposed(dctZigzag[k])];
+						}
+					}
+
+					void idctDequantize(const int16_t *coefs, const float *dequant, float *block, ptrdiff_t stride)
+					{
+						//the coefficients are placed transposed, so the first transposition of idct is not needed
+						alignas(32) int16_t tmp[64];
+						for (int k = 0; k < 64; k++)
+						{
+							tmp[transposed(dctZigzag[k])] = coefs[k];
+						}
+						__m256 v[8];
+						for (int i = 0; i < 8; i++)
+						{
+							__m256i row = _mm256_cvtepi16_epi32(_mm_load_si128((const __m128i*)(tmp + i * 8)));
+							v[i] = _mm256_mul_ps(_mm256_cvtepi32_ps(row), _mm256_loadu_ps(dequant + i * 8));
+						}
+						K8::backTransform(v);
+						transpose(v);
+						K8::backTransform(v);
+						for (int i = 0; i < 8; i++)
+							_mm256_storeu_ps(block + i * stride, v[i]);
+					}
+				}
+				#pragma GCC pop_options
+				#pragma endregion
+#endif
+
+				#pragma region "runtime dispatch"
+				enum dctLevel { DCT_SCALAR, DCT_SSE, DCT_AVX2 };
+				/**
+				 * detects the best instruction set supported by the CPU (and the operating system)
+				 */
+				dctLevel detectLevel()
+				{
+#ifdef _DCT_USE_X86
+					__builtin_cpu_init();
+					if (__builtin_cpu_supports("avx2"))
+						return DCT_AVX2;
+					if (__builtin_cpu_supports("sse2"))
+						return DCT_SSE;
+#endif
+					return DCT_SCALAR;
+				}
+				dctLevel getLevel()
+				{
+					static const dctLevel level = detectLevel();
+					return level;
+				}
+				struct kernelTable
+				{
+					void (*dct)(float*, ptrdiff_t);
+					void (*idct)(float*, ptrdiff_t);
+					void (*dctFixed)(int16_t*, ptrdiff_t);
+					void (*idctFixed)(int16_t*, ptrdiff_t);
+					void (*dctQuantize)(const float*, ptrdiff_t, const float*, int16_t*);
+					void (*idctDequantize)(const int16_t*, const float*, float*, ptrdiff_t);
+				};
+				const kernelTable& getKernels()
+				{
+#ifdef _DCT_USE_X86
+					static const kernelTable avx2Table = { &avx2::dct, &avx2::idct, &avx2::dctFixed, &avx2::idctFixed, &avx2::dctQuantize, &avx2::idctDequantize };
+					static const kernelTable sseTable = { &sse::dct, &sse::idct, &sse::dctFixed, &sse::idctFixed, &sse::dctQuantize, &sse::idctDequantize };
+#endif
+					static const kernelTable scalarTable = { &scalar::dct, &scalar::idct, &scalar::dctFixed, &scalar::idctFixed, &scalar::dctQuantize, &scalar::idctDequantize };
+					switch (getLevel())
+					{
+#ifdef _DCT_USE_X86
+					case DCT_AVX2:
+						return avx2Table;
+					case DCT_SSE:
+						return sseTable;
+#endif
+					default:
+						return scalarTable;
+					}
+				}
+				#pragma endregion
+
+				#pragma region "planes"
+				/**
+				 * Pool of worker threads for the planes. run() hands out the rows of blocks one by one to the workers
+				 * and the calling thread, so fast threads take over the rows of slow ones.
+				 * Only one plane is processed at a time, concurrent calls wait.
+				 */
+				class rowPool
+				{
+				public:
+					static rowPool& get()
+					{
+						static rowPool pool;
+						return pool;
+					}
+					/**
+					 * Calls func(row) for every row 0 ... numRows - 1 with at most numThreads threads and returns when all rows are done
+					 */
+					template<class Func> void run(int numRows, int numThreads, Func &func)
+					{
+						std::lock_guard<std::mutex> jobLock(jobMutex);
+						{
+							std::lock_guard<std::mutex> lock(mutex);
+							job = &callRow<Func>;
+							jobData = &func;
+							rows = numRows;
+							nextRow = 0;
+							active = ((size_t)numThreads - 1 < workers.size()) ? numThreads - 1 : (int)workers.size();
+							pending = active;
+							generation++;
+						}
+						wakeUp.notify_all();
+						work();
+						std::unique_lock<std::mutex> lock(mutex);
+						while (pending > 0)
+						{
+							done.wait(lock);
+						}
+					}
+				private:
+					rowPool() : job(NULL), jobData(NULL), rows(0), nextRow(0), active(0), pending(0), generation(0), stop(false)
+					{
+						int numWorkers = (int)std::thread::hardware_concurrency() - 1;
+						for (int i = 0; i < numWorkers; i++)
+						{
+							workers.push_back(std::thread(&rowPool::workerLoop, this, i));
+						}
+					}
+					~rowPool()
+					{
+						{
+							std::lock_guard<std::mutex> lock(mutex);
+							stop = true;
+						}
+						wakeUp.notify_all();
+						for (size_t i = 0; i < workers.size(); i++)
+						{
+							workers[i].join();
+						}
+					}
+					//disallow copy and assign
+					rowPool(const rowPool&);
+					void operator=(const rowPool&);
+
+					template<class Func> static void callRow(void *func, int row)
+					{
+						(*(Func*)func)(row);
+					}
+					void work()
+					{
+						int row;
+						while ((row = nextRow.fetch_add(1)) < rows)
+						{
+							job(jobData, row);
+						}
+					}
+					void workerLoop(int index)
+					{
+						unsigned long long seen = 0;
+						std::unique_lock<std::mutex> lock(mutex);
+						for (;;)
+						{
+							while (!stop && (generation == seen))
+							{
+								wakeUp.wait(lock);
+							}
+							if (stop)
+								return;
+							seen = generation;
+							if (index < active)
+							{
+								lock.unlock();
+								work();
+								lock.lock();
+								if (--pending == 0)
+								{
+									done.notify_one();
+								}
+							}
+						}
+					}
+
+					std::vector<std::thread> workers;
+					std::mutex jobMutex; //one plane at a time
+					std::mutex mutex;
+					std::condition_variable wakeUp, done;
+					void (*job)(void*, int);
+					void *jobData;
+					int rows;
+					std::atomic<int> nextRow;
+					int active; //number of workers which take part in the current job
+					int pending; //number of workers which are not finished with the current job
+					unsigned long long generation;
+					bool stop;
+				};
+
+				/**
+				 * Fills the part of the block behind the plane (columns >= width, rows >= height) with 0 or the last column/row
+				 */
+				void padBlock(float *block, int cols, int rows, ptrdiff_t stride, dctPadding padding)
+				{
+					for (int y = 0; y < rows; y++)
+					{
+						float *row = block + y * stride;
+						float value = (padding == DCT_PAD_REPLICATE) ? row[cols - 1] : 0.0f;
+						for (int x = cols; x < 8; x++)
+						{
+							row[x] = value;
+						}
+					}
+					for (int y = rows; y < 8; y++)
+					{
+						float *row = block + y * stride;
+						for (int x = 0; x < 8; x++)
+						{
+							row[x] = (padding == DCT_PAD_REPLICATE) ? block[(rows - 1) * stride + x] : 0.0f;
+						}
+					}
+				}
+
+				/**
+				 * Transforms the plane with the declared kernel, each task is one row of blocks (8 rows of the plane)
+				 */
+				void transformPlane(float *plane, int width, int height, ptrdiff_t stride, dctPadding padding, int numThreads, bool inverse)
+				{
+					if ((width < 0) || (height < 0))
+						throw std::invalid_argument("width and height must not be negative");
+					int blocksX = (padding == DCT_PAD_SKIP) ? width / 8 : (width + 7) / 8;
+					int blocksY = (padding == DCT_PAD_SKIP) ? height / 8 : (height + 7) / 8;
+					if ((blocksX == 0) || (blocksY == 0))
+						return;
+					if ((stride < width) || (stride < blocksX * 8))
+						throw std::invalid_argument("stride is too small for the blocks of a row");
+					if (numThreads <= 0)
+					{
+						numThreads = (int)std::thread::hardware_concurrency();
+					}
+					void (*kernel)(float*, ptrdiff_t) = inverse ? getKernels().idct : getKernels().dct;
+					auto transformRow = [=](int by)
+					{
+						float *row = plane + (ptrdiff_t)by * 8 * stride;
+						int rows = height - by * 8;
+						for (int bx = 0; bx < blocksX; bx++)
+						{
+							float *block = row + bx * 8;
+							int cols = width - bx * 8;
+							if (!inverse && ((cols < 8) || (rows < 8)))
+							{
+								padBlock(block, (cols < 8) ? cols : 8, (rows < 8) ? rows : 8, stride, padding);
+							}
+							kernel(block, stride);
+						}
+					};
+					if ((numThreads <= 1) || (blocksY == 1))
+					{
+						for (int by = 0; by < blocksY; by++)
+						{
+							transformRow(by);
+						}
+						return;
+					}
+					rowPool::get().run(blocksY, numThreads, transformRow);
+				}
+				#pragma endregion
+			}
+
+			/**
+			 * returns the instruction set which is used by dct and idct: "avx2", "sse" or "scalar"
+			 */
+			const char* getDctSimdLevel()
+			{
+				switch (getLevel())
+				{
+				case DCT_AVX2:
+					return "avx2";
+				case DCT_SSE:
+					return "sse";
+				default:
+					return "scalar";
+				}
+			}
+
+			void dct(float *block, ptrdiff_t stride)
+			{
+				getKernels().dct(block, stride);
+			}
+
+			void idct(float *block, ptrdiff_t stride)
+			{
+				getKernels().idct(block, stride);
+			}
+
+			void dct(float *block)
+			{
+				getKernels().dct(block, 8);
+			}
+
+			void idct(float *block)
+			{
+				getKernels().idct(block, 8);
+			}
+
+			void dct(int16_t *block, ptrdiff_t stride)
+			{
+				getKernels().dctFixed(block, stride);
+			}
+
+			void idct(int16_t *block, ptrdiff_t stride)
+			{
+				getKernels().idctFixed(block, stride);
+			}
+
+			void dct(int16_t *block)
+			{
+				getKernels().dctFixed(block, 8);
+			}
+
+			void idct(int16_t *block)
+			{
+				getKernels().idctFixed(block, 8);
+			}
+
+			const uint8_t dctZigzag[64] =
+			{
+				 0,  1,  8, 16,  9,  2,  3, 10,
+				17, 24, 32, 25, 18, 11,  4,  5,
+				12, 19, 26, 33, 40, 48, 41, 34,
+				27, 20, 13,  6,  7, 14, 21, 28,
+				35, 42, 49, 56, 57, 50, 43, 36,
+				29, 22, 15, 23, 30, 37, 44, 51,
+				58, 59, 52, 45, 38, 31, 39, 46,
+				53, 60, 61, 54, 47, 55, 62, 63
+			};
+
+			dctQuantTable::dctQuantTable(const uint16_t *table)
+			{
+				for (int n = 0; n < 64; n++)
+				{
+					if (table[n] == 0)
+						throw std::invalid_argument("quantizer step size must not be 0");
+					//dct() delivers 1/8 of the orthonormal coefficients the table is made for
+					quant[transposed(n)] = 8.0f / (float)table[n];
+					dequant[transposed(n)] = (float)table[n] / 8.0f;
+				}
+			}
+
+			void dctQuantize(const float *block, ptrdiff_t stride, const dctQuantTable &table, int16_t *coefs)
+			{
+				getKernels().dctQuantize(block, stride, table.quant, coefs);
+			}
+
+			void dctQuantize(const float *block, const dctQuantTable &table, int16_t *coefs)
+			{
+				getKernels().dctQuantize(block, 8, table.quant, coefs);
+			}
+
+			void idctDequantize(const int16_t *coefs, const dctQuantTable &table, float *block, ptrdiff_t stride)
+			{
+				getKernels().idctDequantize(coefs, table.dequant, block, stride);
+			}
+
+			void idctDequantize(const int16_t *coefs, const dctQuantTable &table, float *block)
+			{
+				getKernels().idctDequantize(coefs, table.dequant, block, 8);
+			}
+
+			void dctPlane(float *plane, int width, int height, ptrdiff_t stride, dctPadding padding, int numThreads)
+			{
+				transformPlane(plane, width, height, stride, padding, numThreads, false);
+			}
+
+			void idctPlane(float *plane, int width, int height, ptrdiff_t stride, dctPadding padding, int numThreads)
+			{
+				transformPlane(plane, width, height, stride, padding, numThreads, true);
+			}
+		}
+	}
+}
@@ -0,0 +1,151 @@
+/**
+ * @brief 8x8 discrete cosine transformation (DCT-II) and its inverse
+ *
+ * The forward transformation is scaled by K = 1/8 instead of 1/sqrt(8) per dimension,
+ * so the inverse transformation needs no scaling: idct(dct(block)) == block.
+ * Coefficient (u, v) is stored at block[u * 8 + v] (u = first index, v = second index of the input).
+ *
+ * Licence: Released to the PUBLIC DOMAIN
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY OF ANY
+ * KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+ * PARTICULAR PURPOSE.
+ */
+#ifndef _DCT_8X8_H_
+#define _DCT_8X8_H_
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Sys
+{
+	namespace Math
+	{
+		namespace Transformation
+		{
+			//returns the instruction set which is used by dct and idct: "avx2", "sse" or "scalar"
+			const char* getDctSimdLevel();
+
+			//alignment in bytes of the contiguous blocks, e.g. alignas(DCT_ALIGNMENT) float block[64];
+			static const size_t DCT_ALIGNMENT = 32;
+
+			/**
+			 * Transforms a contiguous block in place
+			 * @param *block	-  64 floats (8 rows of 8), aligned to DCT_ALIGNMENT
+			 */
+			void dct(float *block);
+			/**
+			 * Transforms a block back in place
+			 * @param *block	-  64 coefficients as delivered by dct, aligned to DCT_ALIGNMENT
+			 */
+			void idct(float *block);
+
+			/**
+			 * Transforms an 8x8 block in place inside of a bigger plane (e.g. an image)
+			 * @param *block	-  first element of the block, no alignment needed
+			 * @param stride	-  distance in floats between two rows of the plane (>= 8)
+			 */
+			void dct(float *block, ptrdiff_t stride);
+			/**
+			 * Transforms an 8x8 block back in place inside of a bigger plane
+			 * @param *block	-  first coefficient of the block, no alignment needed
+			 * @param stride	-  distance in floats between two rows of the plane (>= 8)
+			 */
+			void idct(float *block, ptrdiff_t stride);
+
+			//number of fractional bits of the coefficients of the fixed-point version
+			static const int DCT_FIXED_FRACBITS = 3;
+
+			/**
+			 * Fixed-point version of dct: the same factorization with integer constants (13 bits), the results are
+			 * bit-exact on all platforms and for all instruction sets.
+			 * @param *block	-  64 samples in [-1024, 1023] (e.g. 8 bit pixels - 128), aligned to DCT_ALIGNMENT,
+			 *					   replaced by the coefficients of dct() multiplied by 2^DCT_FIXED_FRACBITS (rounded)
+			 */
+			void dct(int16_t *block);
+			/**
+			 * Fixed-point version of idct, the samples are rounded to integers
+			 * @param *block	-  64 coefficients as delivered by the fixed-point dct (or quantized values of them)
+			 */
+			void idct(int16_t *block);
+			/**
+			 * Fixed-point versions for a block inside of a bigger plane
+			 * @param stride	-  distance in samples between two rows of the plane (>= 8)
+			 */
+			void dct(int16_t *block, ptrdiff_t stride);
+			void idct(int16_t *block, ptrdiff_t stride);
+
+			//natural index (row * 8 + column) of the k-th coefficient in zigzag order
+			extern const uint8_t dctZigzag[64];
+
+			/**
+			 * Quantization table prepared for dctQuantize and idctDequantize.
+			 * The table may be allocated with any alignment (e.g. new or std::vector before C++17).
+			 */
+			struct dctQuantTable
+			{
+				/**
+				 * @param *table	-  64 quantizer step sizes in natural order for coefficients in the orthonormal scale of JPEG,
+				 *					   i.e. 8 times the coefficients of dct(). The factor is folded into the prepared table.
+				 * @throw std::invalid_argument - if a step size is 0
+				 */
+				explicit dctQuantTable(const uint16_t *table);
+
+				float quant[64];		//8 / step size, transposed (column * 8 + row)
+				float dequant[64];	//step size / 8, transposed
+			};
+
+			/**
+			 * Transforms a block and quantizes the coefficients in one pass, the block itself is not changed
+			 * @param *block	-  64 floats (8 rows of 8), aligned to DCT_ALIGNMENT
+			 * @param &table	-  quantization table
+			 * @param *coefs	-  receives the 64 quantized coefficients (rounded to nearest) in zigzag order
+			 */
+			void dctQuantize(const float *block, const dctQuantTable &table, int16_t *coefs);
+			/**
+			 * Dequantizes zigzag ordered coefficients and transforms them back in one pass
+			 * @param *coefs	-  64 quantized coefficients in zigzag order as delivered by dctQuantize
+			 * @param &table	-  quantization table
+			 * @param *block	-  receives the 64 samples, aligned to DCT_ALIGNMENT
+			 */
+			void idctDequantize(const int16_t *coefs, const dctQuantTable &table, float *block);
+			/**
+			 * Versions for a block inside of a bigger plane
+			 * @param stride	-  distance in floats between two rows of the plane (>= 8)
+			 */
+			void dctQuantize(const float *block, ptrdiff_t stride, const dctQuantTable &table, int16_t *coefs);
+			void idctDequantize(const int16_t *coefs, const dctQuantTable &table, float *block, ptrdiff_t stride);
+
+			//handling of the partial blocks at the right and bottom border of a plane whose size is not a multiple of 8
+			enum dctPadding
+			{
+				DCT_PAD_SKIP,		//partial blocks are not transformed
+				DCT_PAD_ZERO,		//partial blocks are filled up with 0 before the forward transformation
+				DCT_PAD_REPLICATE	//partial blocks are filled up with the last column/row before the forward transformation
+			};
+
+			/**
+			 * Transforms all 8x8 blocks of a plane in place. The rows of blocks are distributed over a pool of threads
+			 * which is created on first use and kept for the next calls.
+			 * With DCT_PAD_ZERO and DCT_PAD_REPLICATE the plane must have room for the full blocks: the stride must be at
+			 * least width rounded up to a multiple of 8 and the plane must have height rounded up to a multiple of 8 rows.
+			 * @param *plane	-  first pixel of the plane
+			 * @param width		-  number of pixels per row
+			 * @param height	-  number of rows
+			 * @param stride	-  distance in floats between two rows
+			 * @param padding	-  handling of partial blocks
+			 * @param numThreads	-  maximum number of threads (0 = number of cores, 1 = only the calling thread)
+			 * @throw std::invalid_argument - if the size is negative or the stride too small
+			 */
+			void dctPlane(float *plane, int width, int height, ptrdiff_t stride, dctPadding padding = DCT_PAD_REPLICATE, int numThreads = 0);
+			/**
+			 * Transforms all 8x8 blocks of a plane back in place (see dctPlane).
+			 * With DCT_PAD_ZERO and DCT_PAD_REPLICATE the partial blocks are transformed back completely,
+			 * so the padding area of the plane is overwritten as well.
+			 * @throw std::invalid_argument - if the size is negative or the stride too small
+			 */
+			void idctPlane(float *plane, int width, int height, ptrdiff_t stride, dctPadding padding = DCT_PAD_REPLICATE, int numThreads = 0);
+		}
+	}
+}
+#endif
@@ -0,0 +1,186 @@
+/**
+ * @brief Butterflies of dct_8x8.cpp
+ *
+ * This file is included once for every instruction set (inside of a "#pragma GCC target" region),
+ * so the same one dimensional transformations are compiled for scalar, SSE and AVX2 code
+ * (kernels for float, fixedKernels for the fixed-point version).
+ * Every lane of the vectors is an independent transformation, v[0] ... v[7] are its 8 elements.
+ * The traits class S provides the vector type and the operations:
+ *   V                             - vector type (float for the scalar code)
+ *   set1, add, sub, mul
+ * The operations are done in the same order for every instruction set, so all versions deliver the same results.
+ *
+ * Licence: Released to the PUBLIC DOMAIN
+ */
+template<class S> struct kernels
+{
+	typedef typename S::V V;
+
+	/**
+	 * Performs a one dimensional DCT transformation of block size 8 in every lane
+	 */
+	static inline void transform(V *v)
+	{
+		const V k = S::set1(K);
+		const V ka1 = S::set1(_a1), ka2 = S::set1(_a2), kb1 = S::set1(_b1), kb2 = S::set1(_b2), kc1 = S::set1(_c1), kd1 = S::set1(_d1);
+
+		V s1 = S::add(v[0], v[7]);
+		V m1 = S::sub(v[0], v[7]);
+		V s2 = S::add(v[1], v[6]);
+		V m2 = S::sub(v[1], v[6]);
+		V s3 = S::add(v[2], v[5]);
+		V m3 = S::sub(v[2], v[5]);
+		V s4 = S::add(v[3], v[4]);
+		V m4 = S::sub(v[3], v[4]);
+
+		V ss1 = S::add(s2, s3);
+		V mm1 = S::sub(s2, s3);
+		V ss2 = S::add(s1, s4);
+		V mm2 = S::sub(s1, s4);
+
+		v[0] = S::mul(S::add(ss2, ss1), k);
+		v[1] = S::add(S::add(S::add(S::mul(ka1, m1), S::mul(kb1, m2)), S::mul(kc1, m3)), S::mul(kd1, m4));
+		v[2] = S::add(S::mul(ka2, mm2), S::mul(kb2, mm1));
+		v[3] = S::sub(S::sub(S::sub(S::mul(kb1, m1), S::mul(kd1, m2)), S::mul(ka1, m3)), S::mul(kc1, m4));
+		v[4] = S::mul(S::sub(ss2, ss1), k);
+		v[5] = S::add(S::add(S::sub(S::mul(kc1, m1), S::mul(ka1, m2)), S::mul(kd1, m3)), S::mul(kb1, m4));
+		v[6] = S::sub(S::mul(kb2, mm2), S::mul(ka2, mm1));
+		v[7] = S::sub(S::add(S::sub(S::mul(kd1, m1), S::mul(kc1, m2)), S::mul(kb1, m3)), S::mul(ka1, m4));
+	}
+
+	/**
+	 * Performs a one dimensional inverse DCT transformation of block size 8 in every lane
+	 */
+	static inline void backTransform(V *v)
+	{
+		const V ka1 = S::set1(a1), ka2 = S::set1(a2), kb1 = S::set1(b1), kb2 = S::set1(b2), kc1 = S::set1(c1), kd1 = S::set1(d1);
+
+		//even part
+		V s1 = S::add(v[0], v[4]);
+		V m1 = S::sub(v[0], v[4]);
+		V s2 = S::add(S::mul(ka2, v[2]), S::mul(kb2, v[6]));
+		V m2 = S::sub(S::mul(kb2, v[2]), S::mul(ka2, v[6]));
+
+		V ss1 = S::add(s1, s2);
+		V mm1 = S::sub(s1, s2);
+		V ss2 = S::sub(m1, m2);
+		V mm2 = S::add(m1, m2);
+
+		//odd part
+		V k1 = S::add(S::add(S::add(S::mul(ka1, v[1]), S::mul(kb1, v[3])), S::mul(kc1, v[5])), S::mul(kd1, v[7]));
+		V k2 = S::sub(S::sub(S::sub(S::mul(kb1, v[1]), S::mul(kd1, v[3])), S::mul(ka1, v[5])), S::mul(kc1, v[7]));
+		V k3 = S::add(S::add(S::sub(S::mul(kc1, v[1]), S::mul(ka1, v[3])), S::mul(kd1, v[5])), S::mul(kb1, v[7]));
+		V k4 = S::sub(S::add(S::sub(S::mul(kd1, v[1]), S::mul(kc1, v[3])), S::mul(kb1, v[5])), S::mul(ka1, v[7]));
+
+		v[0] = S::add(ss1, k1);
+		v[1] = S::add(mm2, k2);
+		v[2] = S::add(ss2, k3);
+		v[3] = S::add(mm1, k4);
+		v[4] = S::sub(mm1, k4);
+		v[5] = S::sub(ss2, k3);
+		v[6] = S::sub(mm2, k2);
+		v[7] = S::sub(ss1, k1);
+	}
+};
+
+/**
+ * Fixed-point version of the butterflies with 16 bit samples and the constants scaled by 2^CONST_BITS.
+ * Only the first stage of sums and differences is done with 16 bits, all products are taken pairwise and summed
+ * into 32 bits (pmaddwd), rounded, shifted right by SHIFT bits and saturated to 16 bits again.
+ * The elements are held in pairs of rows: r[0] = (v[0], v[1]), r[1] = (v[2], v[3]), r[2] = (v[4], v[5]), r[3] = (v[6], v[7]).
+ * The traits class S provides the vector types and the operations (with wrap-around on overflow):
+ *   R                             - two rows of int16_t (first and second row)
+ *   P                             - one row of pairs of int16_t
+ *   I                             - one row of int32_t
+ *   addw, subw                    - 16 bit sum and difference of both rows
+ *   swap                          - exchanges the first and the second row
+ *   pairLo(x, y), pairHi(x, y)    - interleaves the first (second) rows of x and y
+ *   madd(p, c0, c1)               - a * c0 + b * c1 in 32 bits for the pairs (a, b) of p and two int16_t constants
+ *   set1i, addi, subi, srai       - 32 bit operations, srai is an arithmetic shift right
+ *   packs(x, y)                   - converts two rows of int32_t to the rows of R with saturation
+ * The sums of products are exact, so all versions deliver the same results.
+ */
+template<class S> struct fixedKernels
+{
+	typedef typename S::R R;
+	typedef typename S::P P;
+	typedef typename S::I I;
+
+	template<int SHIFT> static inline I descale(I x)
+	{
+		return S::srai(S::addi(x, S::set1i(1 << (SHIFT - 1))), SHIFT);
+	}
+	template<int SHIFT> static inline R descale(I x, I y)
+	{
+		return S::packs(descale<SHIFT>(x), descale<SHIFT>(y));
+	}
+
+	/**
+	 * Performs a one dimensional DCT transformation of block size 8 in every lane
+	 */
+	template<int SHIFT> static inline void transform(R *r)
+	{
+		R v32 = S::swap(r[1]);
+		R v76 = S::swap(r[3]);
+		R s12 = S::addw(r[0], v76);
+		R m12 = S::subw(r[0], v76);
+		R s43 = S::addw(v32, r[2]);
+		R m43 = S::subw(v32, r[2]);
+
+		//the second stage of the even part is folded into the constants, its sums could exceed 16 bits
+		P s14 = S::pairLo(s12, s43);
+		P s23 = S::pairHi(s12, s43);
+		P m14 = S::pairLo(m12, m43);
+		P m23 = S::pairHi(m12, m43);
+
+		I ss2 = S::madd(s14, FIX_ONE, FIX_ONE);
+		I ss1 = S::madd(s23, FIX_ONE, FIX_ONE);
+
+		I v0 = S::addi(ss2, ss1);
+		I v1 = S::addi(S::madd(m14, FIX_A1, FIX_D1), S::madd(m23, FIX_B1, FIX_C1));
+		I v2 = S::addi(S::madd(s14, FIX_A2, -FIX_A2), S::madd(s23, FIX_B2, -FIX_B2));
+		I v3 = S::addi(S::madd(m14, FIX_B1, -FIX_C1), S::madd(m23, -FIX_D1, -FIX_A1));
+		I v4 = S::subi(ss2, ss1);
+		I v5 = S::addi(S::madd(m14, FIX_C1, FIX_B1), S::madd(m23, -FIX_A1, FIX_D1));
+		I v6 = S::addi(S::madd(s14, FIX_B2, -FIX_B2), S::madd(s23, -FIX_A2, FIX_A2));
+		I v7 = S::addi(S::madd(m14, FIX_D1, -FIX_A1), S::madd(m23, -FIX_C1, FIX_B1));
+
+		r[0] = descale<SHIFT>(v0, v1);
+		r[1] = descale<SHIFT>(v2, v3);
+		r[2] = descale<SHIFT>(v4, v5);
+		r[3] = descale<SHIFT>(v6, v7);
+	}
+
+	/**
+	 * Performs a one dimensional inverse DCT transformation of block size 8 in every lane
+	 */
+	template<int SHIFT> static inline void backTransform(R *r)
+	{
+		P p04 = S::pairLo(r[0], r[2]);
+		P p15 = S::pairHi(r[0], r[2]);
+		P p26 = S::pairLo(r[1], r[3]);
+		P p37 = S::pairHi(r[1], r[3]);
+
+		//even part
+		I s1 = S::madd(p04, FIX_ONE, FIX_ONE);
+		I m1 = S::madd(p04, FIX_ONE, -FIX_ONE);
+		I s2 = S::madd(p26, FIX_A2, FIX_B2);
+		I m2 = S::madd(p26, FIX_B2, -FIX_A2);
+
+		I ss1 = S::addi(s1, s2);
+		I mm1 = S::subi(s1, s2);
+		I ss2 = S::subi(m1, m2);
+		I mm2 = S::addi(m1, m2);
+
+		//odd part
+		I k1 = S::addi(S::madd(p15, FIX_A1, FIX_C1), S::madd(p37, FIX_B1, FIX_D1));
+		I k2 = S::addi(S::madd(p15, FIX_B1, -FIX_A1), S::madd(p37, -FIX_D1, -FIX_C1));
+		I k3 = S::addi(S::madd(p15, FIX_C1, FIX_D1), S::madd(p37, -FIX_A1, FIX_B1));
+		I k4 = S::addi(S::madd(p15, FIX_D1, FIX_B1), S::madd(p37, -FIX_C1, -FIX_A1));
+
+		r[0] = descale<SHIFT>(S::addi(ss1, k1), S::addi(mm2, k2));
+		r[1] = descale<SHIFT>(S::addi(ss2, k3), S::addi(mm1, k4));
+		r[2] = descale<SHIFT>(S::subi(mm1, k4), S::subi(ss2, k3));
+		r[3] = descale<SHIFT>(S::subi(mm2, k2), S::subi(ss1, k1));
+	}
+};
@@ -0,0 +1,258 @@
+/**
+ * @brief Parallel first-touch initialization of large arrays
+ *
+ * The operating system places a page on the NUMA node of the thread which writes it first.
+ * Initializing a big array from the threads which process it later keeps the memory local to them
+ * and spreads the work of clearing the pages over all cores.
+ *
+ * Licence: Released to the PUBLIC DOMAIN
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY OF ANY
+ * KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+ * PARTICULAR PURPOSE.
+ */
+#ifndef _FIRSTTOUCH_H_
+#define _FIRSTTOUCH_H_
+#include <stdio.h>
+#include <stddef.h>
+#include <thread>
+#include <vector>
+#include <exception>
+#include "rawVector.h"
+
+#ifdef __linux__
+#include <sched.h>
+#define _FIRSTTOUCH_USE_NUMA
+#endif
+
+namespace Sys
+{
+	namespace Array
+	{
+		/**
+		 * Returns the number of NUMA nodes (1 if the system has no NUMA information)
+		 * @return integer
+		 */
+		inline int getNumaNodeCount()
+		{
+			int nodes = 0;
+#ifdef _FIRSTTOUCH_USE_NUMA
+			char path[64];
+			for (;;)
+			{
+				snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", nodes);
+				FILE *file = fopen(path, "r");
+				if (!file)
+				{
+					break;
+				}
+				fclose(file);
+				nodes++;
+			}
+#endif
+			return (nodes > 0) ? nodes : 1;
+		}
+		/**
+		 * Binds the calling thread to the CPUs of the declared NUMA node.
+		 * Does nothing if the node is unknown or binding is not supported.
+		 * @param node				- index of the node (0 ... getNumaNodeCount() - 1)
+		 * @return true if the thread was bound
+		 */
+		inline bool bindThreadToNumaNode(int node)
+		{
+#ifdef _FIRSTTOUCH_USE_NUMA
+			char path[64];
+			snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+			FILE *file = fopen(path, "r");
+			if (!file)
+			{
+				return false;
+			}
+			//cpulist has the format "0-3,8-11"
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			int first, last, count = 0;
+			while (fscanf(file, "%d", &first) == 1)
+			{
+				last = first;
+				int c = fgetc(file);
+				if (c == '-')
+				{
+					if (fscanf(file, "%d", &last) != 1)
+					{
+						break;
+					}
+					c = fgetc(file);
+				}
+				for (int cpu = first; (cpu <= last) && (cpu < CPU_SETSIZE); cpu++)
+				{
+					CPU_SET(cpu, &set);
+					count++;
+				}
+				if (c != ',')
+				{
+					break;
+				}
+			}
+			fclose(file);
+			return (count > 0) && (sched_setaffinity(0, sizeof(set), &set) == 0);
+#else
+			return false;
+#endif
+		}
+		static const size_t FIRSTTOUCH_PAGE_SIZE = 4096;
+
+		/**
+		 * Returns the index of the first element which starts at or behind the border between the parts part - 1 and part
+		 */
+		inline size_t getPartitionBorder(size_t start, size_t count, size_t elementSize, int part, int numParts)
+		{
+			if ((part <= 0) || (count == 0))
+			{
+				return 0;
+			}
+			if (part >= numParts)
+			{
+				return count;
+			}
+			size_t firstPage = start / FIRSTTOUCH_PAGE_SIZE;
+			size_t pages = (start + count * elementSize - 1) / FIRSTTOUCH_PAGE_SIZE - firstPage + 1;
+			size_t border = (firstPage + pages * (size_t)part / (size_t)numParts) * FIRSTTOUCH_PAGE_SIZE;
+			if (border <= start)
+			{
+				return 0;
+			}
+			size_t index = (border - start + elementSize - 1) / elementSize;
+			return (index < count) ? index : count;
+		}
+		/**
+		 * Returns the range of elements which belongs to one part, if the array is split into "numParts" parts.
+		 * parallelInit uses this split, so loops which use it as well touch only memory initialized by their own thread.
+		 * The pages of the array are distributed over the parts and the borders are placed at page boundaries of the
+		 * memory (4 KB), so no page is shared by two parts unless an element crosses a page boundary.
+		 * @param *ptr				- pointer to the first element
+		 * @param count				- number of elements
+		 * @param part				- index of the part (0 ... numParts - 1)
+		 * @param numParts			- number of parts
+		 * @param offset			- receives the index of the first element of the part
+		 * @param length			- receives the number of elements of the part (may be 0)
+		 */
+		template<class T> void getPartition(const T *ptr, size_t count, int part, int numParts, size_t &offset, size_t &length)
+		{
+			size_t begin = getPartitionBorder((size_t)ptr, count, sizeof(T), part, numParts);
+			size_t end = getPartitionBorder((size_t)ptr, count, sizeof(T), part + 1, numParts);
+			offset = begin;
+			length = end - begin;
+		}
+		/**
+		 * Initializes an array with several threads: func(T *ptr, size_t offset, size_t length) is called once per thread
+		 * for the part getPartition(ptr, count, thread, numThreads) and must write all elements of it.
+		 * Use it directly after allocating with rawVector(dim, UNINITIALIZED), before the pages were touched.
+		 * @param *ptr				- pointer to the first element
+		 * @param count				- number of elements
+		 * @param func				- function or lambda, ptr points to element "offset"
+		 * @param numThreads		- number of threads (0 = number of cores)
+		 * @param pinToNodes		- binds thread i to NUMA node i % getNumaNodeCount() (Linux only)
+		 * @throw std::exception	- the first exception thrown by func
+		 * @throw std::system_error	- if a thread cannot be created (the threads already started are finished first)
+		 * @return void
+		 */
+		template<class T, class Func> void parallelInit(T *ptr, size_t count, Func func, int numThreads = 0, bool pinToNodes = false)
+		{
+			if (numThreads <= 0)
+			{
+				numThreads = (int)std::thread::hardware_concurrency();
+				numThreads = (numThreads > 0) ? numThreads : 1;
+			}
+			int numNodes = pinToNodes ? getNumaNodeCount() : 1;
+			std::vector<std::exception_ptr> errors(numThreads);
+			std::vector<std::thread> threads;
+			threads.reserve(numThreads);
+			try
+			{
+				for (int t = 0; t < numThreads; t++)
+				{
+					threads.push_back(std::thread([=, &func, &errors]()
+					{
+						try
+						{
+							if (pinToNodes)
+							{
+								bindThreadToNumaNode(t % numNodes);
+							}
+							size_t offset, length;
+							getPartition(ptr, count, t, numThreads, offset, length);
+							if (length > 0)
+							{
+								func(ptr + offset, offset, length);
+							}
+						}
+						catch (...)
+						{
+							errors[t] = std::current_exception();
+						}
+					}));
+				}
+			}
+			catch (...)
+			{
+				//a thread could not be created, the started ones must be joined before they are destroyed
+				for (size_t t = 0; t < threads.size(); t++)
+				{
+					threads[t].join();
+				}
+				throw;
+			}
+			for (size_t t = 0; t < threads.size(); t++)
+			{
+				threads[t].join();
+			}
+			for (size_t t = 0; t < errors.size(); t++)
+			{
+				if (errors[t])
+				{
+					std::rethrow_exception(errors[t]);
+				}
+			}
+		}
+		/**
+		 * Sets all elements to the declared value with several threads (see parallelInit)
+		 * @param *ptr				- pointer to the first element
+		 * @param count				- number of elements
+		 * @param value				- value of the elements
+		 * @param numThreads		- number of threads (0 = number of cores)
+		 * @param pinToNodes		- binds thread i to NUMA node i % getNumaNodeCount() (Linux only)
+		 * @return void
+		 */
+		template<class T> void parallelFill(T *ptr, size_t count, const T &value, int numThreads = 0, bool pinToNodes = false)
+		{
+			parallelInit(ptr, count, [&value](T *p, size_t, size_t length)
+			{
+				for (size_t i = 0; i < length; i++)
+				{
+					p[i] = value;
+				}
+			}, numThreads, pinToNodes);
+		}
+
+		#pragma region "rawVector versions"
+		/**
+		 * Initializes all elements of the array with several threads, see parallelInit(T*, size_t, ...)
+		 * Example: rawVector<float> arr(dim, UNINITIALIZED); parallelInit(arr, [](float *p, size_t offset, size_t n) { ... });
+		 */
+		template<class T, size_t Alignment, class Allocator, class Func> inline void parallelInit(rawVector<T, Alignment, Allocator> &arr, Func func, int numThreads = 0, bool pinToNodes = false)
+		{
+			parallelInit(arr.getPointer(), (size_t)arr.getSize(), func, numThreads, pinToNodes);
+		}
+		/**
+		 * Sets all elements of the array to the declared value with several threads
+		 */
+		template<class T, size_t Alignment, class Allocator> inline void parallelFill(rawVector<T, Alignment, Allocator> &arr, const T &value, int numThreads = 0, bool pinToNodes = false)
+		{
+			parallelFill(arr.getPointer(), (size_t)arr.getSize(), value, numThreads, pinToNodes);
+		}
+		#pragma endregion
+	}
+}
+#endif
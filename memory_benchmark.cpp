@@ -0,0 +1,516 @@
+/**
+* @brief microbenchmarks for the memory containers
+*
+* Compares StackPtr, SmallVector, ScratchArena, rawVector and segmentedVector with malloc, new[], alloca
+* and std::vector in the cases they are made for:
+* allocation/free latency at different sizes, growth by push_back/append, copy versus move
+* and allocation from several threads at the same time.
+* Every case reports the time per operation (best of several runs) and the number of heap allocations per operation.
+* Allocations are counted by wrapping malloc/free of glibc (other platforms report "-").
+* Build: g++ -O2 -std=c++11 -pthread memory_benchmark.cpp -o memory_benchmark
+*
+* Usage:
+* THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY OF ANY
+* KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <utility>
+#include "rawVector.h"
+#include "segmentedVector.h"
+#include "stackPtr.h"
+#include "smallVector.h"
+#include "scratchArena.h"
+#ifdef _MSC_VER
+#include <malloc.h> // for _alloca
+#define alloca _alloca
+#else
+#include <alloca.h>
+#endif
+
+using namespace std;
+using namespace Sys::Array;
+
+#pragma region "Allocation counter"
+static atomic<unsigned long long> mallocCalls(0);
+
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__)
+#define _BENCH_COUNT_MALLOC
+//glibc exports its allocator under these names, the functions below are found first by the dynamic linker
+extern "C"
+{
+	void* __libc_malloc(size_t size);
+	void* __libc_calloc(size_t num, size_t size);
+	void* __libc_realloc(void *ptr, size_t size);
+	void* __libc_memalign(size_t alignment, size_t size);
+	void __libc_free(void *ptr);
+
+	void* malloc(size_t size)
+	{
+		mallocCalls.fetch_add(1, memory_order_relaxed);
+		return __libc_malloc(size);
+	}
+	void* calloc(size_t num, size_t size)
+	{
+		mallocCalls.fetch_add(1, memory_order_relaxed);
+		return __libc_calloc(num, size);
+	}
+	void* realloc(void *ptr, size_t size)
+	{
+		mallocCalls.fetch_add(1, memory_order_relaxed);
+		return __libc_realloc(ptr, size);
+	}
+	int posix_memalign(void **ptr, size_t alignment, size_t size)
+	{
+		mallocCalls.fetch_add(1, memory_order_relaxed);
+		*ptr = __libc_memalign(alignment, size);
+		return (*ptr || !size) ? 0 : ENOMEM;
+	}
+	void* aligned_alloc(size_t alignment, size_t size)
+	{
+		mallocCalls.fetch_add(1, memory_order_relaxed);
+		return __libc_memalign(alignment, size);
+	}
+	void free(void *ptr)
+	{
+		__libc_free(ptr);
+	}
+}
+#endif
+#pragma endregion
+
+#pragma region "Measurement"
+static volatile size_t sink; //prevents the compiler from removing the measured loops
+
+/**
+* Runs func(iterations) several times and prints the best time per iteration and the allocations per iteration
+* of the best run. If func runs the iterations on several threads at once, the allocations are divided by "threads".
+*/
+template<class Func> static void measure(const char *name, size_t bytes, size_t iterations, Func func, int threads = 1)
+{
+	double best = 1e30;
+	unsigned long long allocs = 0;
+	func(iterations / 10 + 1); //warm-up (caches, arenas)
+	for (int run = 0; run < 5; run++)
+	{
+		unsigned long long calls = mallocCalls.load();
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		func(iterations);
+		double s = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		if (s < best)
+		{
+			best = s;
+			allocs = mallocCalls.load() - calls;
+		}
+	}
+	char size[32];
+	if (bytes)
+		snprintf(size, sizeof(size), "%zu", bytes);
+	else
+		snprintf(size, sizeof(size), "-");
+#ifdef _BENCH_COUNT_MALLOC
+	printf("  %-40s %10s %12.1f %12.3f\n", name, size, best * 1e9 / iterations, (double)allocs / iterations / threads);
+#else
+	(void)allocs;
+	(void)threads;
+	printf("  %-40s %10s %12.1f %12s\n", name, size, best * 1e9 / iterations, "-");
+#endif
+}
+static void header(const char *title)
+{
+	printf("\n%s\n  %-40s %10s %12s %12s\n", title, "case", "bytes", "ns/op", "allocs/op");
+}
+#pragma endregion
+
+#pragma region "Benchmarks"
+//N elements of the inline buffers used for the StackPtr/SmallVector cases
+static const size_t INLINE = 1024;
+
+/**
+* allocation and free of one buffer of "count" floats, the first and last element are written
+*/
+static void benchAllocation()
+{
+	header("allocation + free");
+	const size_t sizes[] = { 4, 64, 1024, 16384, 262144 };
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+	{
+		size_t n = sizes[s];
+		size_t bytes = n * sizeof(float);
+		size_t iter = (n <= 1024) ? 1000000 : 20000;
+		measure("malloc/free", bytes, iter, [n](size_t it)
+		{
+			for (size_t i = 0; i < it; i++)
+			{
+				float *p = (float*)malloc(n * sizeof(float));
+				p[0] = 1; p[n - 1] = 2;
+				sink = sink + (size_t)p[n - 1];
+				free(p);
+			}
+		});
+		measure("new[]/delete[]", bytes, iter, [n](size_t it)
+		{
+			for (size_t i = 0; i < it; i++)
+			{
+				float *p = new float[n];
+				p[0] = 1; p[n - 1] = 2;
+				sink = sink + (size_t)p[n - 1];
+				delete[] p;
+			}
+		});
+		if (bytes <= 65536)
+		{
+			measure("alloca", bytes, iter, [n](size_t it)
+			{
+				for (size_t i = 0; i < it; i++)
+				{
+					float *p = (float*)alloca(n * sizeof(float));
+					p[0] = 1; p[n - 1] = 2;
+					sink = sink + (size_t)p[n - 1];
+				}
+			});
+		}
+		measure("std::vector<float>(n)", bytes, iter, [n](size_t it)
+		{
+			for (size_t i = 0; i < it; i++)
+			{
+				vector<float> v(n);
+				v[n - 1] = 2;
+				sink = sink + (size_t)v[n - 1];
+			}
+		});
+		measure("rawVector<float>(n)", bytes, iter, [n](size_t it)
+		{
+			for (size_t i = 0; i < it; i++)
+			{
+				rawVector<float> v((int)n);
+				v[(int)n - 1] = 2;
+				sink = sink + (size_t)v[(int)n - 1];
+			}
+		});
+		measure("rawVector<float>(n, UNINITIALIZED)", bytes, iter, [n](size_t it)
+		{
+			for (size_t i = 0; i < it; i++)
+			{
+				rawVector<float> v((int)n, UNINITIALIZED);
+				v[0] = 1; v[(int)n - 1] = 2;
+				sink = sink + (size_t)v[(int)n - 1];
+			}
+		});
+		measure("StackPtr<float, 1024>", bytes, iter, [n](size_t it)
+		{
+			for (size_t i = 0; i < it; i++)
+			{
+				StackPtr<float, INLINE> p(n);
+				p[0] = 1; p[n - 1] = 2;
+				sink = sink + (size_t)p[n - 1];
+			}
+		});
+		measure("SmallVector<float, 1024>(n)", bytes, iter, [n](size_t it)
+		{
+			for (size_t i = 0; i < it; i++)
+			{
+				SmallVector<float, INLINE> v(n);
+				v[n - 1] = 2;
+				sink = sink + (size_t)v[n - 1];
+			}
+		});
+		measure("ScratchScope::alloc", bytes, iter, [n](size_t it)
+		{
+			for (size_t i = 0; i < it; i++)
+			{
+				ScratchScope scope;
+				float *p = scope.alloc<float>(n);
+				p[0] = 1; p[n - 1] = 2;
+				sink = sink + (size_t)p[n - 1];
+			}
+		});
+	}
+}
+
+/**
+* several temporary arrays of different size per call, like a kernel with a few work buffers
+*/
+static void benchTemporaries()
+{
+	header("4 temporary arrays per call (64 ... 8192 floats)");
+	const size_t iter = 200000;
+	measure("new[] x4", 0, iter, [](size_t it)
+	{
+		for (size_t i = 0; i < it; i++)
+		{
+			float *a = new float[64], *b = new float[512], *c = new float[2048], *d = new float[8192];
+			a[0] = b[0] = c[0] = d[0] = 1;
+			sink = sink + (size_t)(a[0] + b[0] + c[0] + d[0]);
+			delete[] a; delete[] b; delete[] c; delete[] d;
+		}
+	});
+	measure("StackPtr<float, 1024> x4", 0, iter, [](size_t it)
+	{
+		for (size_t i = 0; i < it; i++)
+		{
+			StackPtr<float, INLINE> a(64), b(512), c(2048), d(8192);
+			a[0] = b[0] = c[0] = d[0] = 1;
+			sink = sink + (size_t)(a[0] + b[0] + c[0] + d[0]);
+		}
+	});
+	measure("ScratchScope x4", 0, iter, [](size_t it)
+	{
+		for (size_t i = 0; i < it; i++)
+		{
+			ScratchScope scope;
+			float *a = scope.alloc<float>(64), *b = scope.alloc<float>(512), *c = scope.alloc<float>(2048), *d = scope.alloc<float>(8192);
+			a[0] = b[0] = c[0] = d[0] = 1;
+			sink = sink + (size_t)(a[0] + b[0] + c[0] + d[0]);
+		}
+	});
+}
+
+/**
+* filling an array whose final size is not known in advance
+*/
+static void benchGrowth()
+{
+	const size_t n = 1 << 20;
+	const size_t iter = 20;
+	header("growth to 1M floats (per element)");
+	measure("std::vector push_back", 0, n * iter, [n](size_t it)
+	{
+		for (size_t r = 0; r < it / n; r++)
+		{
+			vector<float> v;
+			for (size_t i = 0; i < n; i++)
+				v.push_back((float)i);
+			sink = sink + v.size();
+		}
+	});
+	measure("std::vector reserve + push_back", 0, n * iter, [n](size_t it)
+	{
+		for (size_t r = 0; r < it / n; r++)
+		{
+			vector<float> v;
+			v.reserve(n);
+			for (size_t i = 0; i < n; i++)
+				v.push_back((float)i);
+			sink = sink + v.size();
+		}
+	});
+	measure("rawVector push_back", 0, n * iter, [n](size_t it)
+	{
+		for (size_t r = 0; r < it / n; r++)
+		{
+			rawVector<float> v;
+			for (size_t i = 0; i < n; i++)
+				v.push_back((float)i);
+			sink = sink + v.getSize();
+		}
+	});
+	measure("rawVector append (blocks of 256)", 0, n * iter, [n](size_t it)
+	{
+		float block[256];
+		for (int i = 0; i < 256; i++)
+			block[i] = (float)i;
+		for (size_t r = 0; r < it / n; r++)
+		{
+			rawVector<float> v;
+			for (size_t i = 0; i < n; i += 256)
+				v.append(block, 256);
+			sink = sink + v.getSize();
+		}
+	});
+	measure("rawVector setVector (grow by 256)", 0, n * iter, [n](size_t it)
+	{
+		float block[256];
+		for (int i = 0; i < 256; i++)
+			block[i] = (float)i;
+		for (size_t r = 0; r < it / n; r++)
+		{
+			rawVector<float> v;
+			for (size_t i = 0; i < n; i += 256)
+				v.setVector((int)i, block, 256);
+			sink = sink + v.getSize();
+		}
+	});
+	measure("segmentedVector push_back", 0, n * iter, [n](size_t it)
+	{
+		for (size_t r = 0; r < it / n; r++)
+		{
+			segmentedVector<float, 65536> v;
+			for (size_t i = 0; i < n; i++)
+				v.push_back((float)i);
+			sink = sink + v.getSize();
+		}
+	});
+	measure("SmallVector<float, 1024> push_back", 0, n * iter, [n](size_t it)
+	{
+		for (size_t r = 0; r < it / n; r++)
+		{
+			SmallVector<float, INLINE> v;
+			for (size_t i = 0; i < n; i++)
+				v.push_back((float)i);
+			sink = sink + v.size();
+		}
+	});
+}
+
+/**
+* copy versus move of a filled container
+*/
+static void benchCopyMove()
+{
+	const size_t n = 1 << 18;
+	header("copy vs move (256K floats)");
+	vector<float> sv(n, 1.0f);
+	rawVector<float> rv((int)n);
+	SmallVector<float, INLINE> smv(n);
+	segmentedVector<float, 65536> sgv(n);
+	measure("std::vector copy", n * sizeof(float), 2000, [&sv](size_t it)
+	{
+		for (size_t i = 0; i < it; i++)
+		{
+			vector<float> c(sv);
+			sink = sink + c.size();
+		}
+	});
+	measure("std::vector move", n * sizeof(float), 1000000, [&sv](size_t it)
+	{
+		for (size_t i = 0; i < it; i++)
+		{
+			vector<float> c(std::move(sv));
+			sink = sink + c.size();
+			sv = std::move(c);
+		}
+	});
+	measure("rawVector copy", n * sizeof(float), 2000, [&rv](size_t it)
+	{
+		for (size_t i = 0; i < it; i++)
+		{
+			rawVector<float> c(rv);
+			sink = sink + c.getSize();
+		}
+	});
+	measure("rawVector move", n * sizeof(float), 1000000, [&rv](size_t it)
+	{
+		for (size_t i = 0; i < it; i++)
+		{
+			rawVector<float> c(std::move(rv));
+			sink = sink + c.getSize();
+			rv = std::move(c);
+		}
+	});
+	measure("SmallVector copy", n * sizeof(float), 2000, [&smv](size_t it)
+	{
+		for (size_t i = 0; i < it; i++)
+		{
+			SmallVector<float, INLINE> c(smv);
+			sink = sink + c.size();
+		}
+	});
+	measure("SmallVector move", n * sizeof(float), 1000000, [&smv](size_t it)
+	{
+		for (size_t i = 0; i < it; i++)
+		{
+			SmallVector<float, INLINE> c(std::move(smv));
+			sink = sink + c.size();
+			smv = std::move(c);
+		}
+	});
+	measure("segmentedVector copy", n * sizeof(float), 2000, [&sgv](size_t it)
+	{
+		for (size_t i = 0; i < it; i++)
+		{
+			segmentedVector<float, 65536> c(sgv);
+			sink = sink + c.getSize();
+		}
+	});
+	measure("segmentedVector move", n * sizeof(float), 1000000, [&sgv](size_t it)
+	{
+		for (size_t i = 0; i < it; i++)
+		{
+			segmentedVector<float, 65536> c(std::move(sgv));
+			sink = sink + c.getSize();
+			sgv = std::move(c);
+		}
+	});
+}
+
+/**
+* runs body(iterations) on "numThreads" threads at the same time, reports the time and the allocations per operation of one thread
+*/
+template<class Body> static void runThreads(const char *name, int numThreads, size_t iter, Body body)
+{
+	char title[64];
+	snprintf(title, sizeof(title), "%s (%d threads)", name, numThreads);
+	measure(title, 0, iter, [numThreads, &body](size_t it)
+	{
+		vector<thread> threads;
+		for (int t = 0; t < numThreads; t++)
+			threads.push_back(thread([it, &body]() { body(it); }));
+		for (size_t t = 0; t < threads.size(); t++)
+			threads[t].join();
+	}, numThreads);
+}
+
+/**
+* allocation of 8 KB buffers from several threads at the same time
+*/
+static void benchContention()
+{
+	header("multithreaded allocation of 8 KB buffers (per op and thread)");
+	const size_t n = 2048;
+	const size_t iter = 200000;
+	int maxThreads = (int)thread::hardware_concurrency();
+	maxThreads = (maxThreads < 4) ? 4 : maxThreads;
+	for (int threads = 1; threads <= maxThreads; threads *= 2)
+	{
+		runThreads("malloc/free", threads, iter, [n](size_t it)
+		{
+			for (size_t i = 0; i < it; i++)
+			{
+				float *p = (float*)malloc(n * sizeof(float));
+				p[0] = 1;
+				sink = sink + (size_t)p[0];
+				free(p);
+			}
+		});
+		runThreads("StackPtr<float, 64> spill", threads, iter, [n](size_t it)
+		{
+			for (size_t i = 0; i < it; i++)
+			{
+				StackPtr<float, 64> p(n);
+				p[0] = 1;
+				sink = sink + (size_t)p[0];
+			}
+		});
+		runThreads("ScratchScope::alloc", threads, iter, [n](size_t it)
+		{
+			for (size_t i = 0; i < it; i++)
+			{
+				ScratchScope scope;
+				float *p = scope.alloc<float>(n);
+				p[0] = 1;
+				sink = sink + (size_t)p[0];
+			}
+		});
+	}
+}
+#pragma endregion
+
+int main()
+{
+	printf("memory container benchmark (best of 5 runs)\n");
+	benchAllocation();
+	benchTemporaries();
+	benchGrowth();
+	benchCopyMove();
+	benchContention();
+	return 0;
+}
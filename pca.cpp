@@ -179,6 +179,31 @@ namespace Sys
 					pOutVecs += dimension;
 				}
 			}
+			/**
+			 * Calculates the principal components of the samples in the declared view
+			 * @param samples	    -  contiguous view of the sample vectors, the number of samples is samples.getSize() / dimension
+			 * @param pVecs         -  contiguous view which receives numComponents vectors of the declared dimension
+			 * @param numComponents -  number of principal components which should be calculated
+			 * @param dimension     -  Number of dimensions of each sample vector
+			 * @throw std::invalid_argument - if the views are not contiguous or do not fit the dimension
+			 * @return              -  none
+			 */
+			void PCA::calcPCA(Sys::Array::rawVectorView<const float> samples, Sys::Array::rawVectorView<float> pVecs, int numComponents, int dimension)
+			{
+				if (!samples.isContiguous() || !pVecs.isContiguous())
+				{
+					throw std::invalid_argument("views must be contiguous!");
+				}
+				if ((dimension <= 0) || (samples.getSize() % dimension != 0))
+				{
+					throw std::invalid_argument("size of samples must be a multiple of dimension!");
+				}
+				if ((numComponents > 0) && (pVecs.getSize() / numComponents < dimension))
+				{
+					throw std::invalid_argument("pVecs is too small!");
+				}
+				calcPCA(samples.getPointer(), samples.getSize() / dimension, pVecs.getPointer(), numComponents, dimension);
+			}
 		}
 	}
 }
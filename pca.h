@@ -20,29 +20,28 @@
 #include <string.h>
 #include <stdexcept>
 #include <vector>
+#include "rawVectorView.h"
 
 using namespace std;
-/*
+
 namespace Sys
 {
 	namespace Math
 	{
 		namespace Transformation
 		{
-			*/
 			class PCA
 			{
 			public:
 				static void calcPCA(const float *samples, int numSamples, float* pVecs, int numComponents, int dimension);
+				static void calcPCA(Sys::Array::rawVectorView<const float> samples, Sys::Array::rawVectorView<float> pVecs, int numComponents, int dimension);
 			private:
 				static void getMean(const float *samples, float *meanVec, int numSamples, int dimension);
 				static void subtractVector(float *samples, const float *vec, int numSamples, int dimension);
 				static void getComponent(const float *samples, int numSamples, int dimension, float *tmpVec, float *outPCAVec, float &maxlength2);
 				static void removeComponent(float *samples, int numSamples, float* pVec, float length2, int dimension);
 			};
-
-			/*
 		}
 	}
-}*/
+}
 #endif
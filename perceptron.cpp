@@ -92,13 +92,57 @@ namespace Sys
 			void Perceptron::feedback(float target, float* input)
 			{
 				float* w = weights;
-				float d = learningRate * error(target, input);
+				float d = learningRate * error(target, Sys::Array::rawVectorView<const float>(input, size));
 				bias += d;
 				for (int i = 0; i < size; i++)
 				{
 					(*w++) += (*input++) * d;
 				}
 			}
+			/**
+			 * calculates the output of the perceptron based on the declared input view (any stride) and weights
+			 * @param input                 - view of the input vector with the dimension declared in the constructor
+			 * @throw std::invalid_argument - if the size of the view does not fit
+			 * @return                      - result of the calculation (between 0.0 and 1.0)
+			 */
+			float Perceptron::calculate(Sys::Array::rawVectorView<const float> input)
+			{
+				if (input.getSize() != size)
+				{
+					throw invalid_argument("input size does not fit the Perceptron size");
+				}
+				const float* in = input.getPointer();
+				int stride = input.getStride();
+				result = bias;
+				for (int i = 0; i < size; i++)
+				{
+					result += in[i * stride] * weights[i];
+				}
+				result = activation(result);
+				return result;
+			}
+			/**
+			 * adapts the weights of the perceptron
+			 * @param target                - value which should have been returned by calculate()
+			 * @param input                 - the same input view used for calculate()
+			 * @throw std::invalid_argument - if the size of the view does not fit
+			 * @return                      - none
+			 */
+			void Perceptron::feedback(float target, Sys::Array::rawVectorView<const float> input)
+			{
+				if (input.getSize() != size)
+				{
+					throw invalid_argument("input size does not fit the Perceptron size");
+				}
+				const float* in = input.getPointer();
+				int stride = input.getStride();
+				float d = learningRate * error(target, input);
+				bias += d;
+				for (int i = 0; i < size; i++)
+				{
+					weights[i] += in[i * stride] * d;
+				}
+			}
 			/**
 			 * Changes the learning rate of the Perceptron
 			 * @param learningRate          - float point value between 0.0 and 1.0
@@ -157,10 +201,10 @@ namespace Sys
 			/**
 			 * lerning rule of the perceptron. The function is called inside of feedback()
 			 * @param target                - first parameter of feedback()
-			 * @param input                 - second parameter of feedback()
+			 * @param input                 - second parameter of feedback() (any stride)
 			 * @return                      - desired error
 			 */
-			float Perceptron::error(float target, float* input)
+			float Perceptron::error(float target, Sys::Array::rawVectorView<const float> input)
 			{
 				return (target - result);
 			}
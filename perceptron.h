@@ -23,6 +23,7 @@
 #include <iostream> // just there for the NULL definition...
 #include <fstream>
 #include <random>
+#include "rawVectorView.h"
 
 using namespace std;
 
@@ -39,11 +40,13 @@ namespace Sys
 				virtual ~Perceptron();
 				inline float calculate(float* input);
 				inline void feedback(float target, float* input);
+				float calculate(Sys::Array::rawVectorView<const float> input);
+				void feedback(float target, Sys::Array::rawVectorView<const float> input);
 				inline float setLearningRate(float learningRate);
 				void loadFile(const char *fileName);
 				void saveFile(const char *fileName);
 			protected:
-				inline float error(float target, float* input); //can be overwritten to implement own error function
+				inline float error(float target, Sys::Array::rawVectorView<const float> input); //can be overwritten to implement own error function
 				inline static float activation(float res); //can be overwritten to implement own activation function
 				//members
 				int size;
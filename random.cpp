@@ -63,42 +63,6 @@ namespace Sys
 			offset = (seed == 0) ? 1 : seed; //Make sure offset is not 0 at the beginning!
 #endif
 		}
-		/**
-		* returns a uniform distributed 32 bit random value
-		*/
-		uint32_t Random::getUInt32()
-		{
-#ifdef USE_RANDOM_BUFFER
-			offsetA %= BLOCKSIZEA;
-			offsetB %= BLOCKSIZEB;
-			return rndBaseA[offsetA++] ^ rndBaseB[offsetB++];
-#else
-			offset *= 16807;
-			return offset;
-#endif
-		}
-		/**
-		* returns a uniform distributed random float value between 0.0 and 1.0
-		*/
-		float Random::getFloat()
-		{
-			//set exponent to 0, so the coresponding value must be 127 (01111111 binary)
-			//00000000011111111111111111111111 binar is 0x007FFFFF
-			//00111111100000000000000000000000 binar is 0x3F800000
-			uint32_t rnd = ((getUInt32() & 0x007FFFFF) | 0x3F800000);
-			return (*(float*)&rnd) - 1.0f;
-		}
-		/**
-		* returns a uniform distributed random float value between -1.0 and 1.0
-		*/
-		inline float Random::getFloat2()
-		{
-			//here the exponent is 1, so the coresponding value must be 128 (10000000 binary)
-			//00000000011111111111111111111111 binar is 0x007FFFFF
-			//01000000000000000000000000000000 binar is 0x40000000
-			uint32_t rnd = ((getUInt32() & 0x007FFFFF) | 0x40000000);
-			return (*(float*)&rnd) - 3.0f;
-		}
 #ifdef USE_RANDOM_BUFFER
 		const uint32_t Random::rndBaseA[BLOCKSIZEA] = {
 			0x5C1B896D, 0x3D7141B5, 0xB5F80CE5, 0xF652E0CA, 0x23D10A00, 0xD1594116, 0x2B049072, 0xCDFEAF5D, 0xE98EDC7, 0xF6704A9, 0x5E6CD15C, 0x9161803F, 0x4750713D, 0x981C3F0E, 0x4A9C8230, 0xFE40802D, 0x494527CC, 0x4C40D7D, 0xF58B4489, 0x23351627, 0xFDB085B, 0xD131907C, 0xCBD930D5, 0xF0AA6C0C, 0x2677C7BC, 0xD5C21A7D, 0x5C7CAB0F, 0x2639BF2D, 0xAC8B21BA, 0x1DC4A615, 
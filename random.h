@@ -21,9 +21,12 @@
 #define USE_RANDOM_BUFFER
 
 #include <time.h>
+#include <stddef.h>
+#include <string.h>
 //Visual C++ does not support architecture independant "int32_t" data type before VS 2010
 #ifdef _MSC_VER
 typedef unsigned int uint32_t;  //Visual C++ also uses "unsigned int" instead of "unsigned __int32" 
+typedef unsigned __int64 uint64_t;
 #else
 #include <stdint.h>
 #endif
@@ -39,12 +42,28 @@ namespace Sys
 		class Random
 		{
 		public:
-			inline Random();
-			inline Random(uint32_t seed);
-			inline void seed(uint32_t seed);
+			//UniformRandomBitGenerator interface, so Random can be used with std::shuffle, std::sample and the <random> distributions
+			typedef uint32_t result_type;
+			static constexpr result_type min() { return 0; }
+			static constexpr result_type max() { return 0xFFFFFFFF; }
+			inline result_type operator()();
+			inline void discard(unsigned long long n);
+
+			Random();
+			Random(uint32_t seed);
+			void seed(uint32_t seed);
 			inline uint32_t getUInt32();
 			inline float getFloat();
 			inline float getFloat2();
+			inline double getDouble();
+			inline double getDouble2();
+			inline uint32_t getBounded(uint32_t n);
+			inline void getBounded(uint32_t n, uint32_t *out, size_t count);
+			inline void getUInt32(uint32_t *out, size_t count);
+			static inline float toFloat(uint32_t rnd);
+			static inline float toFloat2(uint32_t rnd);
+			static inline double toDouble(uint64_t rnd);
+			static inline double toDouble2(uint64_t rnd);
 
 		private:
 #ifdef USE_RANDOM_BUFFER
@@ -55,6 +74,501 @@ namespace Sys
 			uint32_t offset;
 #endif
 		};
+
+		#pragma region "Inline Methods of class Random"
+		/**
+		* returns a uniform distributed 32 bit random value (same as getUInt32)
+		*/
+		Random::result_type Random::operator()()
+		{
+			return getUInt32();
+		}
+		/**
+		* Advances the state as if getUInt32 had been called n times
+		* @param n	- number of values to skip
+		*/
+		void Random::discard(unsigned long long n)
+		{
+#ifdef USE_RANDOM_BUFFER
+			offsetA = offsetA % BLOCKSIZEA + (uint32_t)(n % BLOCKSIZEA);
+			offsetB = offsetB % BLOCKSIZEB + (uint32_t)(n % BLOCKSIZEB);
+#else
+			//offset * 16807^n, the power is calculated by squaring (modulo 2^32 by overflow)
+			uint32_t factor = 16807;
+			while (n)
+			{
+				if (n & 1)
+					offset *= factor;
+				factor *= factor;
+				n >>= 1;
+			}
+#endif
+		}
+		/**
+		* returns a uniform distributed 32 bit random value
+		*/
+		uint32_t Random::getUInt32()
+		{
+#ifdef USE_RANDOM_BUFFER
+			offsetA %= BLOCKSIZEA;
+			offsetB %= BLOCKSIZEB;
+			return rndBaseA[offsetA++] ^ rndBaseB[offsetB++];
+#else
+			offset *= 16807;
+			return offset;
+#endif
+		}
+		/**
+		* returns a uniform distributed random float value between 0.0 and 1.0
+		*/
+		float Random::getFloat()
+		{
+			return toFloat(getUInt32());
+		}
+		/**
+		* returns a uniform distributed random float value between -1.0 and 1.0
+		*/
+		float Random::getFloat2()
+		{
+			return toFloat2(getUInt32());
+		}
+		/**
+		* returns a uniform distributed random double value between 0.0 and 1.0 with 52 bit resolution
+		*/
+		double Random::getDouble()
+		{
+			uint64_t hi = getUInt32();
+			return toDouble((hi << 32) | getUInt32());
+		}
+		/**
+		* returns a uniform distributed random double value between -1.0 and 1.0 with 52 bit resolution
+		*/
+		double Random::getDouble2()
+		{
+			uint64_t hi = getUInt32();
+			return toDouble2((hi << 32) | getUInt32());
+		}
+		/**
+		* returns a uniform distributed random integer between 0 and n - 1 without modulo bias.
+		* Uses Lemire's nearly divisionless method: the 32x32 bit product is scaled down by 2^32 and
+		* only in the rare case of a possibly biased result a division is needed to reject the value.
+		* @param n	- number of possible values, if n is 0 the result is 0
+		*/
+		uint32_t Random::getBounded(uint32_t n)
+		{
+			uint64_t m = (uint64_t)getUInt32() * n;
+			uint32_t low = (uint32_t)m;
+			if (low < n)
+			{
+				if (n == 0)
+					return 0;
+				uint32_t threshold = (0 - n) % n; //2^32 mod n
+				while (low < threshold)
+				{
+					m = (uint64_t)getUInt32() * n;
+					low = (uint32_t)m;
+				}
+			}
+			return (uint32_t)(m >> 32);
+		}
+		/**
+		* fills the array with uniform distributed random integers between 0 and n - 1 without modulo bias
+		* @param n			- number of possible values, if n is 0 all values are 0
+		* @param *out		- destination array
+		* @param count		- number of values
+		*/
+		void Random::getBounded(uint32_t n, uint32_t *out, size_t count)
+		{
+			if (n == 0)
+			{
+				memset(out, 0, count * sizeof(uint32_t));
+				return;
+			}
+			uint32_t threshold = (0 - n) % n; //calculated only once for the whole batch
+			for (size_t i = 0; i < count; i++)
+			{
+				uint64_t m = (uint64_t)getUInt32() * n;
+				while ((uint32_t)m < threshold)
+				{
+					m = (uint64_t)getUInt32() * n;
+				}
+				out[i] = (uint32_t)(m >> 32);
+			}
+		}
+		/**
+		* fills the array with uniform distributed 32 bit random values
+		* @param *out		- destination array
+		* @param count		- number of values
+		*/
+		void Random::getUInt32(uint32_t *out, size_t count)
+		{
+#ifdef USE_RANDOM_BUFFER
+			//copy runs of both tables until one of them wraps around, so the inner loop has no modulo
+			offsetA %= BLOCKSIZEA;
+			offsetB %= BLOCKSIZEB;
+			while (count)
+			{
+				size_t num = count;
+				if (num > BLOCKSIZEA - offsetA)
+					num = BLOCKSIZEA - offsetA;
+				if (num > BLOCKSIZEB - offsetB)
+					num = BLOCKSIZEB - offsetB;
+				const uint32_t *a = &rndBaseA[offsetA], *b = &rndBaseB[offsetB];
+				for (size_t i = 0; i < num; i++)
+				{
+					out[i] = a[i] ^ b[i];
+				}
+				out += num;
+				count -= num;
+				offsetA = (offsetA + (uint32_t)num) % BLOCKSIZEA;
+				offsetB = (offsetB + (uint32_t)num) % BLOCKSIZEB;
+			}
+#else
+			for (size_t i = 0; i < count; i++)
+			{
+				out[i] = getUInt32();
+			}
+#endif
+		}
+		/**
+		* converts a 32 bit random value to a float value between 0.0 and 1.0 (the lower 23 bits are used)
+		* @param rnd	- uniform distributed 32 bit random value
+		*/
+		float Random::toFloat(uint32_t rnd)
+		{
+			//set exponent to 0, so the coresponding value must be 127 (01111111 binary)
+			//00000000011111111111111111111111 binar is 0x007FFFFF
+			//00111111100000000000000000000000 binar is 0x3F800000
+			rnd = ((rnd & 0x007FFFFF) | 0x3F800000);
+			float result;
+			memcpy(&result, &rnd, sizeof(float)); //same as *(float*)&rnd, but without breaking strict aliasing now that it gets inlined
+			return result - 1.0f;
+		}
+		/**
+		* converts a 32 bit random value to a float value between -1.0 and 1.0 (the lower 23 bits are used)
+		* @param rnd	- uniform distributed 32 bit random value
+		*/
+		float Random::toFloat2(uint32_t rnd)
+		{
+			//here the exponent is 1, so the coresponding value must be 128 (10000000 binary)
+			//00000000011111111111111111111111 binar is 0x007FFFFF
+			//01000000000000000000000000000000 binar is 0x40000000
+			rnd = ((rnd & 0x007FFFFF) | 0x40000000);
+			float result;
+			memcpy(&result, &rnd, sizeof(float));
+			return result - 3.0f;
+		}
+		/**
+		* converts a 64 bit random value to a double value between 0.0 and 1.0 (the lower 52 bits are used)
+		* @param rnd	- uniform distributed 64 bit random value
+		*/
+		double Random::toDouble(uint64_t rnd)
+		{
+			//same as toFloat: exponent 1023 gives values between 1.0 and 2.0
+			rnd = ((rnd & 0x000FFFFFFFFFFFFFULL) | 0x3FF0000000000000ULL);
+			double result;
+			memcpy(&result, &rnd, sizeof(double));
+			return result - 1.0;
+		}
+		/**
+		* converts a 64 bit random value to a double value between -1.0 and 1.0 (the lower 52 bits are used)
+		* @param rnd	- uniform distributed 64 bit random value
+		*/
+		double Random::toDouble2(uint64_t rnd)
+		{
+			//exponent 1024 gives values between 2.0 and 4.0
+			rnd = ((rnd & 0x000FFFFFFFFFFFFFULL) | 0x4000000000000000ULL);
+			double result;
+			memcpy(&result, &rnd, sizeof(double));
+			return result - 3.0;
+		}
+		#pragma endregion
+
+		/**
+		* counter based random number generator (Philox4x32-10)
+		* Each value is a pure function of (key, counter), so the value at any stream position can be
+		* calculated directly. Parallel jobs get the same results no matter how the work is split.
+		* The generated numbers are not cryptographically secure!
+		*/
+		class CounterRandom
+		{
+		public:
+			typedef uint32_t result_type;
+			static constexpr result_type min() { return 0; }
+			static constexpr result_type max() { return 0xFFFFFFFF; }
+			inline result_type operator()();
+			inline void discard(unsigned long long n);
+
+			inline CounterRandom(uint64_t key = 0, uint64_t counter = 0);
+			inline void seed(uint64_t key, uint64_t counter = 0);
+			inline uint64_t getCounter();
+			inline uint32_t getUInt32();
+			inline float getFloat();
+			inline float getFloat2();
+
+			static inline uint32_t get(uint64_t key, uint64_t counter);
+			static inline void get(uint64_t key, uint64_t counter, uint32_t *out, size_t count);
+			static inline float getFloat(uint64_t key, uint64_t counter);
+			static inline float getFloat2(uint64_t key, uint64_t counter);
+			static inline void getFloat(uint64_t key, uint64_t counter, float *out, size_t count);
+			static inline void getFloat2(uint64_t key, uint64_t counter, float *out, size_t count);
+
+		private:
+			static inline void block(uint32_t k0, uint32_t k1, uint64_t blockIdx, uint32_t out[4]);
+
+			static const uint32_t M0 = 0xD2511F53, M1 = 0xCD9E8D57; //round multipliers
+			static const uint32_t W0 = 0x9E3779B9, W1 = 0xBB67AE85; //key schedule (Weyl sequence)
+			static const int ROUNDS = 10;
+			static const size_t BATCH = 16; //number of blocks processed side by side in the bulk path
+			uint64_t key, counter;
+		};
+
+		#pragma region "Inline Methods of class CounterRandom"
+		/**
+		* Creates a new instance of the CounterRandom class
+		* @param key		- stream key (seed), different keys give independent streams
+		* @param counter	- start position in the stream
+		*/
+		CounterRandom::CounterRandom(uint64_t key, uint64_t counter)
+		{
+			this->key = key;
+			this->counter = counter;
+		}
+		/**
+		* Sets a new key and stream position
+		* @param key		- stream key
+		* @param counter	- position in the stream
+		*/
+		void CounterRandom::seed(uint64_t key, uint64_t counter)
+		{
+			this->key = key;
+			this->counter = counter;
+		}
+		/**
+		* returns the current position in the stream
+		*/
+		uint64_t CounterRandom::getCounter()
+		{
+			return counter;
+		}
+		/**
+		* returns the value at the current stream position (same as getUInt32)
+		*/
+		CounterRandom::result_type CounterRandom::operator()()
+		{
+			return getUInt32();
+		}
+		/**
+		* Skips n values in O(1)
+		* @param n	- number of values to skip
+		*/
+		void CounterRandom::discard(unsigned long long n)
+		{
+			counter += n;
+		}
+		/**
+		* returns the uniform distributed 32 bit random value at the current stream position and advances by one
+		*/
+		uint32_t CounterRandom::getUInt32()
+		{
+			return get(key, counter++);
+		}
+		/**
+		* returns a uniform distributed random float value between 0.0 and 1.0
+		*/
+		float CounterRandom::getFloat()
+		{
+			return Random::toFloat(getUInt32());
+		}
+		/**
+		* returns a uniform distributed random float value between -1.0 and 1.0
+		*/
+		float CounterRandom::getFloat2()
+		{
+			return Random::toFloat2(getUInt32());
+		}
+		/**
+		* calculates one Philox block (four 32 bit values)
+		* @param k0, k1		- lower and upper half of the key
+		* @param blockIdx	- 64 bit block counter (the upper 64 bit of the 128 bit counter are 0)
+		* @param out		- receives the four values of the block
+		*/
+		void CounterRandom::block(uint32_t k0, uint32_t k1, uint64_t blockIdx, uint32_t out[4])
+		{
+			uint32_t c0 = (uint32_t)blockIdx, c1 = (uint32_t)(blockIdx >> 32), c2 = 0, c3 = 0;
+			for (int r = 0; r < ROUNDS; r++)
+			{
+				uint64_t p0 = (uint64_t)M0 * c0;
+				uint64_t p1 = (uint64_t)M1 * c2;
+				uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+				uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+				c1 = (uint32_t)p1;
+				c3 = (uint32_t)p0;
+				c0 = n0;
+				c2 = n2;
+				k0 += W0;
+				k1 += W1;
+			}
+			out[0] = c0;
+			out[1] = c1;
+			out[2] = c2;
+			out[3] = c3;
+		}
+		/**
+		* returns the value at the declared stream position without generating the values before it
+		* @param key		- stream key
+		* @param counter	- position in the stream
+		*/
+		uint32_t CounterRandom::get(uint64_t key, uint64_t counter)
+		{
+			uint32_t res[4];
+			block((uint32_t)key, (uint32_t)(key >> 32), counter >> 2, res);
+			return res[counter & 3];
+		}
+		/**
+		* fills the array with the values at the stream positions counter ... counter + count - 1
+		* The blocks are calculated in batches with the counters in separate lanes, so the compiler can vectorize the rounds.
+		* @param key		- stream key
+		* @param counter	- position of the first value
+		* @param *out		- destination array
+		* @param count		- number of values
+		*/
+		void CounterRandom::get(uint64_t key, uint64_t counter, uint32_t *out, size_t count)
+		{
+			uint32_t res[4];
+			uint32_t k0 = (uint32_t)key, k1 = (uint32_t)(key >> 32);
+			//leading values until the counter is at a block boundary
+			while ((counter & 3) && count)
+			{
+				*out++ = get(key, counter++);
+				count--;
+			}
+			uint64_t blockIdx = counter >> 2;
+			while (count >= BATCH * 4)
+			{
+				uint32_t c0[BATCH], c1[BATCH], c2[BATCH], c3[BATCH];
+				for (size_t i = 0; i < BATCH; i++)
+				{
+					c0[i] = (uint32_t)(blockIdx + i);
+					c1[i] = (uint32_t)((blockIdx + i) >> 32);
+					c2[i] = 0;
+					c3[i] = 0;
+				}
+				uint32_t rk0 = k0, rk1 = k1;
+				for (int r = 0; r < ROUNDS; r++)
+				{
+					for (size_t i = 0; i < BATCH; i++)
+					{
+						uint64_t p0 = (uint64_t)M0 * c0[i];
+						uint64_t p1 = (uint64_t)M1 * c2[i];
+						uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1[i] ^ rk0;
+						uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3[i] ^ rk1;
+						c1[i] = (uint32_t)p1;
+						c3[i] = (uint32_t)p0;
+						c0[i] = n0;
+						c2[i] = n2;
+					}
+					rk0 += W0;
+					rk1 += W1;
+				}
+				for (size_t i = 0; i < BATCH; i++)
+				{
+					out[4 * i + 0] = c0[i];
+					out[4 * i + 1] = c1[i];
+					out[4 * i + 2] = c2[i];
+					out[4 * i + 3] = c3[i];
+				}
+				out += BATCH * 4;
+				count -= BATCH * 4;
+				blockIdx += BATCH;
+			}
+			while (count)
+			{
+				block(k0, k1, blockIdx++, res);
+				for (int i = 0; i < 4 && count; i++)
+				{
+					*out++ = res[i];
+					count--;
+				}
+			}
+		}
+		/**
+		* returns the float value between 0.0 and 1.0 at the declared stream position
+		* @param key		- stream key
+		* @param counter	- position in the stream
+		*/
+		float CounterRandom::getFloat(uint64_t key, uint64_t counter)
+		{
+			return Random::toFloat(get(key, counter));
+		}
+		/**
+		* returns the float value between -1.0 and 1.0 at the declared stream position
+		* @param key		- stream key
+		* @param counter	- position in the stream
+		*/
+		float CounterRandom::getFloat2(uint64_t key, uint64_t counter)
+		{
+			return Random::toFloat2(get(key, counter));
+		}
+		/**
+		* fills the array with float values between 0.0 and 1.0 of the stream positions counter ... counter + count - 1
+		* @param key		- stream key
+		* @param counter	- position of the first value
+		* @param *out		- destination array
+		* @param count		- number of values
+		*/
+		void CounterRandom::getFloat(uint64_t key, uint64_t counter, float *out, size_t count)
+		{
+			uint32_t rnd[BATCH * 4];
+			//leading values until the counter is at a block boundary, so every chunk takes the batched path
+			while ((counter & 3) && count)
+			{
+				*out++ = Random::toFloat(get(key, counter++));
+				count--;
+			}
+			while (count)
+			{
+				size_t num = (count < BATCH * 4) ? count : BATCH * 4;
+				get(key, counter, rnd, num);
+				for (size_t i = 0; i < num; i++)
+				{
+					out[i] = Random::toFloat(rnd[i]);
+				}
+				out += num;
+				counter += num;
+				count -= num;
+			}
+		}
+		/**
+		* fills the array with float values between -1.0 and 1.0 of the stream positions counter ... counter + count - 1
+		* @param key		- stream key
+		* @param counter	- position of the first value
+		* @param *out		- destination array
+		* @param count		- number of values
+		*/
+		void CounterRandom::getFloat2(uint64_t key, uint64_t counter, float *out, size_t count)
+		{
+			uint32_t rnd[BATCH * 4];
+			//leading values until the counter is at a block boundary, so every chunk takes the batched path
+			while ((counter & 3) && count)
+			{
+				*out++ = Random::toFloat2(get(key, counter++));
+				count--;
+			}
+			while (count)
+			{
+				size_t num = (count < BATCH * 4) ? count : BATCH * 4;
+				get(key, counter, rnd, num);
+				for (size_t i = 0; i < num; i++)
+				{
+					out[i] = Random::toFloat2(rnd[i]);
+				}
+				out += num;
+				counter += num;
+				count -= num;
+			}
+		}
+		#pragma endregion
 	}
 }
 #endif
@@ -0,0 +1,315 @@
+/**
+* @brief statistical quality and throughput tests for the random number generators
+*
+* Runs a small battery of statistical tests (frequency, serial, gap, birthday spacings, linear complexity)
+* on every engine and measures the speed of the scalar and bulk paths.
+* std::mt19937 is included as reference.
+* Build: g++ -O2 -std=c++11 random_test.cpp random.cpp -o random_test
+* The program returns 1 if at least one test failed.
+*
+* Usage:
+* THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY OF ANY
+* KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*/
+#include <math.h>
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "random.h"
+
+using namespace std;
+using namespace Sys::Misc;
+
+//p-values outside of [ALPHA, 1 - ALPHA] are treated as failure
+static const double ALPHA = 0.0001;
+static int failures = 0;
+
+#pragma region "Statistic helpers"
+/**
+* regularized upper incomplete gamma function Q(a, x)
+* (series expansion for x < a + 1, otherwise continued fraction)
+*/
+static double gammaQ(double a, double x)
+{
+	if (x <= 0.0)
+		return 1.0;
+	double gln = lgamma(a);
+	if (x < a + 1.0)
+	{
+		double ap = a, sum = 1.0 / a, del = sum;
+		for (int n = 0; n < 1000; n++)
+		{
+			ap += 1.0;
+			del *= x / ap;
+			sum += del;
+			if (fabs(del) < fabs(sum) * 1e-15)
+				break;
+		}
+		return 1.0 - sum * exp(-x + a * log(x) - gln);
+	}
+	double b = x + 1.0 - a, c = 1.0 / 1e-300, d = 1.0 / b, h = d;
+	for (int i = 1; i < 1000; i++)
+	{
+		double an = -i * (i - a);
+		b += 2.0;
+		d = an * d + b;
+		if (fabs(d) < 1e-300)
+			d = 1e-300;
+		c = b + an / c;
+		if (fabs(c) < 1e-300)
+			c = 1e-300;
+		d = 1.0 / d;
+		double del = d * c;
+		h *= del;
+		if (fabs(del - 1.0) < 1e-15)
+			break;
+	}
+	return exp(-x + a * log(x) - gln) * h;
+}
+/**
+* chi-square test of observed against expected counts
+* @return p-value
+*/
+static double chiSquare(const vector<double> &observed, const vector<double> &expected)
+{
+	double chi2 = 0.0;
+	for (size_t i = 0; i < observed.size(); i++)
+	{
+		double d = observed[i] - expected[i];
+		chi2 += d * d / expected[i];
+	}
+	return gammaQ((observed.size() - 1) / 2.0, chi2 / 2.0);
+}
+static void report(const char *test, double p)
+{
+	bool ok = (p >= ALPHA) && (p <= 1.0 - ALPHA);
+	if (!ok)
+		failures++;
+	printf("    %-24s p = %.6f  %s\n", test, p, ok ? "PASS" : "FAIL");
+}
+#pragma endregion
+
+#pragma region "Statistical tests"
+/**
+* frequency (monobit) test: the number of one bits must be close to half of all bits
+*/
+template<class Engine> static double frequencyTest(Engine &rnd, size_t numValues)
+{
+	long long ones = 0;
+	for (size_t i = 0; i < numValues; i++)
+	{
+		uint32_t v = rnd();
+		for (int b = 0; b < 32; b++)
+			ones += (v >> b) & 1;
+	}
+	double bits = 32.0 * numValues;
+	double z = (ones - bits / 2.0) / sqrt(bits / 4.0);
+	return erfc(fabs(z) / sqrt(2.0));
+}
+/**
+* serial test: pairs of consecutive 4 bit values (taken from the top of each value) must be uniform over all 256 combinations
+*/
+template<class Engine> static double serialTest(Engine &rnd, size_t numPairs)
+{
+	vector<double> observed(256, 0.0), expected(256, numPairs / 256.0);
+	for (size_t i = 0; i < numPairs; i++)
+	{
+		uint32_t a = rnd() >> 28;
+		uint32_t b = rnd() >> 28;
+		observed[a * 16 + b] += 1.0;
+	}
+	return chiSquare(observed, expected);
+}
+/**
+* gap test: the lengths of gaps between values in [0.0, 0.5) must be geometrically distributed
+*/
+template<class Engine> static double gapTest(Engine &rnd, size_t numGaps)
+{
+	const int MAXGAP = 16;
+	vector<double> observed(MAXGAP + 1, 0.0), expected(MAXGAP + 1);
+	double p = 1.0;
+	for (int r = 0; r < MAXGAP; r++)
+	{
+		p *= 0.5;
+		expected[r] = numGaps * p; //P(gap = r) = 0.5 * 0.5^r
+	}
+	expected[MAXGAP] = numGaps * p; //P(gap >= MAXGAP)
+	for (size_t i = 0; i < numGaps; i++)
+	{
+		int gap = 0;
+		while (Random::toFloat(rnd()) >= 0.5f)
+			gap++;
+		observed[(gap < MAXGAP) ? gap : MAXGAP] += 1.0;
+	}
+	return chiSquare(observed, expected);
+}
+/**
+* birthday spacings test (Marsaglia): 512 birthdays in a year of 2^24 days,
+* the number of duplicate spacings is Poisson distributed with lambda = 512^3 / 2^26 = 2
+*/
+template<class Engine> static double birthdaySpacingsTest(Engine &rnd, int numRounds)
+{
+	const int M = 512;
+	const int CLASSES = 6; //0 ... 4 and >= 5 duplicates
+	const double lambda = 2.0;
+	vector<double> observed(CLASSES, 0.0), expected(CLASSES);
+	double term = exp(-lambda), sum = 0.0;
+	for (int k = 0; k < CLASSES - 1; k++)
+	{
+		expected[k] = numRounds * term;
+		sum += term;
+		term *= lambda / (k + 1);
+	}
+	expected[CLASSES - 1] = numRounds * (1.0 - sum);
+
+	vector<uint32_t> days(M), spacings(M);
+	for (int round = 0; round < numRounds; round++)
+	{
+		for (int i = 0; i < M; i++)
+			days[i] = rnd() >> 8;
+		sort(days.begin(), days.end());
+		spacings[0] = days[0];
+		for (int i = 1; i < M; i++)
+			spacings[i] = days[i] - days[i - 1];
+		sort(spacings.begin(), spacings.end());
+		int duplicates = 0;
+		for (int i = 1; i < M; i++)
+		{
+			if (spacings[i] == spacings[i - 1])
+				duplicates++;
+		}
+		observed[(duplicates < CLASSES - 1) ? duplicates : CLASSES - 1] += 1.0;
+	}
+	return chiSquare(observed, expected);
+}
+/**
+* linear complexity of a bit sequence (Berlekamp-Massey algorithm)
+*/
+static int linearComplexity(const vector<unsigned char> &s)
+{
+	int n = (int)s.size(), L = 0, m = -1;
+	vector<unsigned char> c(n, 0), b(n, 0), t;
+	c[0] = b[0] = 1;
+	for (int i = 0; i < n; i++)
+	{
+		int d = s[i];
+		for (int j = 1; j <= L; j++)
+			d ^= c[j] & s[i - j];
+		if (d)
+		{
+			t = c;
+			for (int j = 0; j + i - m < n; j++)
+				c[j + i - m] ^= b[j];
+			if (L <= i / 2)
+			{
+				L = i + 1 - L;
+				m = i;
+				b = t;
+			}
+		}
+	}
+	return L;
+}
+/**
+* linear complexity test (NIST SP 800-22) on the lowest bit of each value,
+* which is the weakest bit of multiplicative generators
+*/
+template<class Engine> static double linearComplexityTest(Engine &rnd, int numBlocks)
+{
+	const int M = 500;
+	static const double pi[7] = { 0.010417, 0.03125, 0.125, 0.5, 0.25, 0.0625, 0.020833 };
+	double mu = M / 2.0 + (9.0 - 1.0) / 36.0 - (M / 3.0 + 2.0 / 9.0) / pow(2.0, M); //M is even
+	vector<double> observed(7, 0.0), expected(7);
+	for (int i = 0; i < 7; i++)
+		expected[i] = numBlocks * pi[i];
+	vector<unsigned char> bits(M);
+	for (int block = 0; block < numBlocks; block++)
+	{
+		for (int i = 0; i < M; i++)
+			bits[i] = rnd() & 1;
+		double t = (linearComplexity(bits) - mu) + 2.0 / 9.0;
+		int idx;
+		if (t <= -2.5) idx = 0;
+		else if (t <= -1.5) idx = 1;
+		else if (t <= -0.5) idx = 2;
+		else if (t <= 0.5) idx = 3;
+		else if (t <= 1.5) idx = 4;
+		else if (t <= 2.5) idx = 5;
+		else idx = 6;
+		observed[idx] += 1.0;
+	}
+	return chiSquare(observed, expected);
+}
+template<class Engine> static void runBattery(const char *name, Engine &rnd)
+{
+	printf("  %s\n", name);
+	report("frequency", frequencyTest(rnd, 1 << 20));
+	report("serial", serialTest(rnd, 1 << 20));
+	report("gap", gapTest(rnd, 1 << 18));
+	report("birthday spacings", birthdaySpacingsTest(rnd, 2000));
+	report("linear complexity", linearComplexityTest(rnd, 1000));
+}
+#pragma endregion
+
+#pragma region "Throughput"
+static volatile uint32_t sink; //prevents the compiler from removing the measured loops
+/**
+* measures the declared function and prints ns per value and GB/s
+* @param func	- function which generates "count" values of "bytesPerValue" bytes
+*/
+template<class Func> static void measure(const char *name, size_t count, size_t bytesPerValue, Func func)
+{
+	func(); //warm up
+	int reps = 5;
+	double best = 1e30;
+	for (int r = 0; r < reps; r++)
+	{
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		func();
+		double s = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		best = (s < best) ? s : best;
+	}
+	printf("  %-36s %8.3f ns/value %8.2f GB/s\n", name, best * 1e9 / count, count * bytesPerValue / best / 1e9);
+}
+static void runThroughput()
+{
+	const size_t N = 1 << 22;
+	vector<uint32_t> buf(N);
+	vector<float> fbuf(N);
+	Random rnd(12345);
+	CounterRandom crnd(12345);
+	mt19937 mt(12345);
+
+	measure("Random::getUInt32 (scalar)", N, 4, [&]() { uint32_t s = 0; for (size_t i = 0; i < N; i++) s += rnd.getUInt32(); sink = s; });
+	measure("Random::getUInt32 (bulk)", N, 4, [&]() { rnd.getUInt32(&buf[0], N); sink = buf[N - 1]; });
+	measure("Random::getFloat (scalar)", N, 4, [&]() { float s = 0; for (size_t i = 0; i < N; i++) s += rnd.getFloat(); sink = (uint32_t)s; });
+	measure("Random::getDouble (scalar)", N, 8, [&]() { double s = 0; for (size_t i = 0; i < N; i++) s += rnd.getDouble(); sink = (uint32_t)s; });
+	measure("Random::getBounded (scalar)", N, 4, [&]() { uint32_t s = 0; for (size_t i = 0; i < N; i++) s += rnd.getBounded(1000); sink = s; });
+	measure("Random::getBounded (bulk)", N, 4, [&]() { rnd.getBounded(1000, &buf[0], N); sink = buf[N - 1]; });
+	measure("CounterRandom::getUInt32 (scalar)", N, 4, [&]() { uint32_t s = 0; for (size_t i = 0; i < N; i++) s += crnd.getUInt32(); sink = s; });
+	measure("CounterRandom::get (bulk)", N, 4, [&]() { CounterRandom::get(1, 0, &buf[0], N); sink = buf[N - 1]; });
+	measure("CounterRandom::getFloat (bulk)", N, 4, [&]() { CounterRandom::getFloat(1, 0, &fbuf[0], N); sink = (uint32_t)fbuf[N - 1]; });
+	measure("std::mt19937 (scalar)", N, 4, [&]() { uint32_t s = 0; for (size_t i = 0; i < N; i++) s += mt(); sink = s; });
+}
+#pragma endregion
+
+int main()
+{
+	printf("Statistical tests (fail if p < %g or p > %g)\n", ALPHA, 1.0 - ALPHA);
+	Random rnd(12345);
+	runBattery("Random", rnd);
+	CounterRandom crnd(12345);
+	runBattery("CounterRandom", crnd);
+	mt19937 mt(12345);
+	runBattery("std::mt19937 (reference)", mt);
+
+	printf("\nThroughput\n");
+	runThroughput();
+
+	printf("\n%d test(s) failed\n", failures);
+	return (failures > 0) ? 1 : 0;
+}
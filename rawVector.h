@@ -18,35 +18,123 @@
 #define _RAWVECTORCLASS_H_
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 #include <stdexcept>
+#include <type_traits>
+#include <ios>
+#include "allocators.h"
+#include "rawVectorView.h"
+#ifdef _USE_ALLOC_TELEMETRY
+#include "allocTelemetry.h"
+#define _RAWVECTOR_RECORD(call) getAllocRecord<rawVectorTag, T>("rawVector", 0).call
+#else
+#define _RAWVECTOR_RECORD(call)
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#define _RAWVECTOR_USE_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 namespace Sys
 {
 	namespace Array
 	{
+		/**
+		 * Page mode which is used for arrays of at least HUGE_PAGE_SIZE bytes
+		 * PAGES_DEFAULT            - normal heap memory
+		 * PAGES_TRANSPARENT_HUGE   - anonymous mapping which is advised to be backed by transparent huge pages
+		 * PAGES_EXPLICIT_HUGE      - mapping from the reserved huge page pool (falls back to transparent huge pages if the pool is empty)
+		 */
+		enum PageMode { PAGES_DEFAULT, PAGES_TRANSPARENT_HUGE, PAGES_EXPLICIT_HUGE };
+		static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+		//zero-initialized arrays of heapAllocator with at least this size are mapped from the system (pages are zeroed lazily)
+		static const size_t LAZY_ZERO_SIZE = 128 * 1024;
+		/**
+		 * Access mode of a file mapped with rawVector::mapFile
+		 * FILE_READONLY            - the pages are mapped read-only: methods which change the array (setVector, append,
+		 *                            push_back, reserve, ...) throw std::logic_error, writing through operator[]
+		 *                            or getPointer() is not detected and crashes the process (SIGSEGV)
+		 * FILE_READWRITE           - shared mapping, changes go to the file (created if it does not exist)
+		 */
+		enum FileMode { FILE_READONLY, FILE_READWRITE };
+		/**
+		 * Tag for the constructor rawVector(dim, UNINITIALIZED) which does not zero the elements.
+		 * Large blocks are not even touched, so no physical memory is used until the elements are written
+		 * (see parallelInit in firstTouch.h to write them from the threads which work on them).
+		 */
+		struct uninitializedTag {};
+		static const uninitializedTag UNINITIALIZED = uninitializedTag();
+
 		//Array helper class
 		/**
 		 * Helper class for management of dynamic raw arrays.
 		 * In contrast to the vector class this class DOES NOT CALL THE CONSTRUCTOR for elements.
 		 * Thus it should be used only with primitive types like int, float, double...
+		 * The memory is aligned to "Alignment" bytes (64 by default, so SIMD loads do not cross cache lines).
+		 * The memory is requested from "Allocator" (see allocators.h), e.g. arenaAllocator or poolAllocator
+		 * to take all arrays of a request from one region which is freed in one call.
 		 */
-		template<class T> class rawVector //used for dynamic memory allocation
+		template<class T, size_t Alignment = 64, class Allocator = heapAllocator> class rawVector //used for dynamic memory allocation
 		{
+			static_assert((Alignment & (Alignment - 1)) == 0, "Alignment must be a power of 2");
 		public:
 			rawVector();
-			rawVector(int dim);
-			rawVector(T *src, int dim);
+			explicit rawVector(const Allocator &alloc);
+			rawVector(int dim, const Allocator &alloc = Allocator());
+			rawVector(int dim, uninitializedTag, const Allocator &alloc = Allocator());
+			rawVector(T *src, int dim, const Allocator &alloc = Allocator());
 			rawVector(const rawVector&);
+			rawVector(rawVector&&) noexcept;
 			~rawVector();
 			void operator=(const rawVector&);
+			void operator=(rawVector&&) noexcept;
+			void swap(rawVector &arr) noexcept;
+			T* release();
+			void adopt(T *ptr, int dim);
 			inline T& operator[](int idx);
 			inline int getSize();
+			inline int getCapacity();
 			inline T* getPointer();
 			void clear();
 			void setVector(int offset, const T *vec, int dim);
+			void setVector(int offset, rawVectorView<const T> vec);
+			inline rawVectorView<T> view();
+			rawVectorView<T> view(int offset, int count, int step = 1);
+			void append(const T *vec, int dim);
+			inline void push_back(const T &value);
+			void reserve(int capacity);
+			void shrink_to_fit();
+			inline void setPageMode(PageMode mode);
+			inline PageMode getPageMode();
+			inline Allocator getAllocator();
+			void mapFile(const char *fileName, FileMode mode);
+			void sync();
+			inline bool isFileMapped();
 		private:
+			//origin of the memory block (huge page, zero page and file mappings bypass the allocator)
+			enum MemoryKind { MEMORY_ALLOCATOR, MEMORY_MAPPED, MEMORY_HUGETLB, MEMORY_ZEROED, MEMORY_FILE };
+
+			void grow(int minCapacity);
+			void reallocate(int capacity);
+			T* allocBlock(int &capacity, MemoryKind &kind, bool zero = false);
+			void freeBlock(T *ptr, int capacity, MemoryKind kind);
+			static inline size_t mappedSize(size_t bytes);
+			static inline size_t roundToPages(size_t bytes);
+			void mapFileRegion(int capacity);
+			void unmapFile();
+
 			T* pointer;
 			int sz;
+			int cap; //number of allocated elements, always >= sz
+			PageMode pageMode;
+			MemoryKind kind;
+			Allocator alloc;
+			int fd; //file descriptor of a mapped file, otherwise -1
+			bool readOnly;
 		};
 
 		#pragma region "Public Methods of class rawVector"
@@ -54,48 +142,78 @@ namespace Sys
 		 * Initializes a rawVector with NULL pointer
 		 * @return - none
 		 */
-		template<class T> rawVector<T>::rawVector()
+		template<class T, size_t Alignment, class Allocator> rawVector<T, Alignment, Allocator>::rawVector()
+		{
+			pointer = NULL;
+			sz = 0;
+			cap = 0;
+			pageMode = PAGES_DEFAULT;
+			kind = MEMORY_ALLOCATOR;
+			fd = -1;
+			readOnly = false;
+		}
+		/**
+		 * Initializes an empty rawVector which takes its memory from the declared allocator
+		 * @return - none
+		 */
+		template<class T, size_t Alignment, class Allocator> rawVector<T, Alignment, Allocator>::rawVector(const Allocator &alloc) : alloc(alloc)
 		{
 			pointer = NULL;
 			sz = 0;
+			cap = 0;
+			pageMode = PAGES_DEFAULT;
+			kind = MEMORY_ALLOCATOR;
+			fd = -1;
+			readOnly = false;
 		}
 		/**
-		 * Initializes a rawVector with the declared dimension
+		 * Initializes a rawVector with the declared dimension, all elements are 0.
+		 * With heapAllocator arrays of at least LAZY_ZERO_SIZE bytes are zeroed lazily by the system (like calloc),
+		 * so they only use physical memory for the pages which are touched.
 	     * @throw std::bad_alloc - if memory allocation fails	
 		 */
-		template<class T> rawVector<T>::rawVector(int dim)
+		template<class T, size_t Alignment, class Allocator> rawVector<T, Alignment, Allocator>::rawVector(int dim, const Allocator &alloc) : alloc(alloc)
 		{
-			pointer = (T*)calloc(dim, sizeof(T));
-			if (pointer)
-			{
-				sz = dim;
-			}
-			else
-			{
-				throw std::bad_alloc();
-			}
+			pageMode = PAGES_DEFAULT;
+			fd = -1;
+			readOnly = false;
+			cap = dim;
+			pointer = allocBlock(cap, kind, true);
+			sz = dim;
+		}
+		/**
+		 * Initializes a rawVector with the declared dimension without initializing the elements.
+		 * The content is undefined until it is written.
+		 * Usage: rawVector<float> arr(dim, UNINITIALIZED);
+	     * @throw std::bad_alloc - if memory allocation fails
+		 */
+		template<class T, size_t Alignment, class Allocator> rawVector<T, Alignment, Allocator>::rawVector(int dim, uninitializedTag, const Allocator &alloc) : alloc(alloc)
+		{
+			pageMode = PAGES_DEFAULT;
+			fd = -1;
+			readOnly = false;
+			cap = dim;
+			pointer = allocBlock(cap, kind);
+			sz = dim;
 		}
 		/**
 		 * Initializes a rawVector with a copy of the declared pointer with declared dimension.
 	     * @throw std::invalid_argument - if invalid pointer or size
 	     * @throw std::bad_alloc        - if memory allocation fails
 		 */
-		template<class T> rawVector<T>::rawVector(T *src, int dim)
+		template<class T, size_t Alignment, class Allocator> rawVector<T, Alignment, Allocator>::rawVector(T *src, int dim, const Allocator &alloc) : alloc(alloc)
 		{
+			pageMode = PAGES_DEFAULT;
+			fd = -1;
+			readOnly = false;
 			if (dim > 0)
 			{
 				if ((src != NULL))
 				{
-					pointer = (T*)malloc(dim * sizeof(T));
-					if (pointer != NULL)
-					{
-						memcpy(pointer, src, dim * sizeof(T));
-						sz = dim;
-					}
-					else
-					{
-						throw std::bad_alloc();
-					}
+					cap = dim;
+					pointer = allocBlock(cap, kind);
+					memcpy(pointer, src, dim * sizeof(T));
+					sz = dim;
 				}
 				else
 				{
@@ -111,18 +229,23 @@ namespace Sys
 		 * create a copy of the declared array
 		 * @return - none
 		 */
-		template<class T> rawVector<T>::rawVector(const rawVector<T>& arr)
+		template<class T, size_t Alignment, class Allocator> rawVector<T, Alignment, Allocator>::rawVector(const rawVector<T, Alignment, Allocator>& arr) : alloc(arr.alloc)
 		{
 			//This must be done first (because clear will be called)
 			pointer = NULL;
 			sz = 0;
+			cap = 0;
+			pageMode = arr.pageMode;
+			kind = MEMORY_ALLOCATOR;
+			fd = -1;
+			readOnly = false;
 			(*this) = arr;
 		}
 		/**
 		 * Frees reserved memory
 		 * @return - none
 		 */
-		template<class T> rawVector<T>::~rawVector()
+		template<class T, size_t Alignment, class Allocator> rawVector<T, Alignment, Allocator>::~rawVector()
 		{
 			clear();
 		}
@@ -131,33 +254,170 @@ namespace Sys
 		 * @return					- none
 	     * @throw std::bad_alloc	- if memory allocation fails
 		 */
-		template<class T> void rawVector<T>::operator=(const rawVector<T>& arr)
+		template<class T, size_t Alignment, class Allocator> void rawVector<T, Alignment, Allocator>::operator=(const rawVector<T, Alignment, Allocator>& arr)
 		{
+			if (this == &arr)
+			{
+				return;
+			}
 			clear(); //Make sure old memory is freed correctly
-			if (arr.pointer)
+			if (arr.pointer && arr.sz > 0)
 			{
-				this->pointer = (T*)malloc(arr.sz * sizeof(T));
-				if (this->pointer)
-				{
-					memcpy(this->pointer, arr.pointer, arr.sz * sizeof(T));
-					this->sz = arr.sz;
-				}
-				else
-				{
-					throw std::bad_alloc();
-				}
+				int capacity = arr.sz;
+				this->pointer = allocBlock(capacity, this->kind);
+				memcpy(this->pointer, arr.pointer, arr.sz * sizeof(T));
+				this->sz = arr.sz;
+				this->cap = capacity;
 			}
 			else
 			{
 				this->pointer = NULL;
 				this->sz = 0;
+				this->cap = 0;
+			}
+		}
+		/**
+		 * Takes over the memory of the declared array without copying, the declared array is empty afterwards
+		 * @return - none
+		 */
+		template<class T, size_t Alignment, class Allocator> rawVector<T, Alignment, Allocator>::rawVector(rawVector<T, Alignment, Allocator>&& arr) noexcept : alloc(arr.alloc)
+		{
+			pointer = arr.pointer;
+			sz = arr.sz;
+			cap = arr.cap;
+			pageMode = arr.pageMode;
+			kind = arr.kind;
+			fd = arr.fd;
+			readOnly = arr.readOnly;
+			arr.pointer = NULL;
+			arr.sz = 0;
+			arr.cap = 0;
+			arr.kind = MEMORY_ALLOCATOR;
+			arr.fd = -1;
+			arr.readOnly = false;
+		}
+		/**
+		 * Frees the own memory and takes over the memory of the declared array without copying
+		 * @return - none
+		 */
+		template<class T, size_t Alignment, class Allocator> void rawVector<T, Alignment, Allocator>::operator=(rawVector<T, Alignment, Allocator>&& arr) noexcept
+		{
+			if (this != &arr)
+			{
+				clear();
+				swap(arr);
+			}
+		}
+		/**
+		 * Exchanges the content of both arrays without copying the elements
+		 * @return - none
+		 */
+		template<class T, size_t Alignment, class Allocator> void rawVector<T, Alignment, Allocator>::swap(rawVector<T, Alignment, Allocator> &arr) noexcept
+		{
+			T *tmpPointer = pointer; pointer = arr.pointer; arr.pointer = tmpPointer;
+			int tmpSz = sz; sz = arr.sz; arr.sz = tmpSz;
+			int tmpCap = cap; cap = arr.cap; arr.cap = tmpCap;
+			PageMode tmpMode = pageMode; pageMode = arr.pageMode; arr.pageMode = tmpMode;
+			MemoryKind tmpKind = kind; kind = arr.kind; arr.kind = tmpKind;
+			Allocator tmpAlloc = alloc; alloc = arr.alloc; arr.alloc = tmpAlloc;
+			int tmpFd = fd; fd = arr.fd; arr.fd = tmpFd;
+			bool tmpReadOnly = readOnly; readOnly = arr.readOnly; arr.readOnly = tmpReadOnly;
+		}
+		/**
+		 * Hands the memory over to the caller, the array is empty afterwards.
+		 * The caller must free the pointer with free() (_aligned_free() with Visual C++).
+		 * A large zero-initialized block which is mapped from the system is copied once into a heap block.
+		 * @throw std::logic_error	- if the memory is mapped (huge pages) and cannot be freed with free()
+		 * @throw std::bad_alloc	- if the copy of a mapped block cannot be allocated
+		 * @return pointer to the first element (NULL if the array is empty)
+		 */
+		template<class T, size_t Alignment, class Allocator> T* rawVector<T, Alignment, Allocator>::release()
+		{
+			static_assert(std::is_same<Allocator, heapAllocator>::value, "release() is only supported with heapAllocator");
+			if (kind == MEMORY_ZEROED)
+			{
+				reallocate(sz); //the block goes to the heap with the capacity cut to the size
+			}
+			if (kind != MEMORY_ALLOCATOR)
+			{
+				throw std::logic_error("mapped memory cannot be released");
+			}
+			T *ptr = pointer;
+			if (ptr)
+			{
+				_RAWVECTOR_RECORD(onFree((size_t)cap * sizeof(T))); //the block leaves the array
+			}
+			pointer = NULL;
+			sz = 0;
+			cap = 0;
+			return ptr;
+		}
+		/**
+		 * Takes ownership of an existing buffer, the old content of the array is freed.
+		 * The buffer is given back with alignedFree(), so it must come from alignedAlloc(), release() or
+		 * on Visual C++ from _aligned_malloc() (not malloc()), elsewhere from malloc() or posix_memalign().
+		 * If the buffer does not fulfill the alignment of the array it is copied once into an aligned block and freed.
+		 * Ownership passes in any case: if the copy cannot be allocated, the buffer is freed and the array is not changed.
+		 * If the buffer is the one of the array itself, only the size is set to dim.
+		 * @param *ptr				- buffer which will be owned by the array afterwards
+		 * @param dim				- number of elements in the buffer
+		 * @throw std::invalid_argument	- if invalid pointer or size (or dim exceeds the capacity of the own buffer)
+		 * @throw std::bad_alloc		- if memory allocation fails
+		 * @return - none
+		 */
+		template<class T, size_t Alignment, class Allocator> void rawVector<T, Alignment, Allocator>::adopt(T *ptr, int dim)
+		{
+			static_assert(std::is_same<Allocator, heapAllocator>::value, "adopt() is only supported with heapAllocator");
+			if ((ptr == NULL) || (dim <= 0))
+			{
+				throw std::invalid_argument("invalid pointer or size");
+			}
+			if (ptr == pointer)
+			{
+				if (dim > cap)
+				{
+					throw std::invalid_argument("invalid pointer or size");
+				}
+				sz = dim;
+				return;
+			}
+			if (((size_t)ptr & (Alignment - 1)) == 0)
+			{
+				clear();
+				pointer = ptr;
+				sz = dim;
+				cap = dim;
+				kind = MEMORY_ALLOCATOR;
+				_RAWVECTOR_RECORD(onAllocate((size_t)dim * sizeof(T)));
+			}
+			else
+			{
+				int capacity = dim;
+				MemoryKind newKind;
+				T *block;
+				try
+				{
+					block = allocBlock(capacity, newKind);
+				}
+				catch (...)
+				{
+					alignedFree(ptr);
+					throw;
+				}
+				memcpy(block, ptr, dim * sizeof(T));
+				alignedFree(ptr);
+				clear();
+				pointer = block;
+				sz = dim;
+				cap = capacity;
+				kind = newKind;
 			}
 		}
 		/**
 		 * Returns the entry at the declared offset
 		 * @return reference to element of type T
 		 */		
-		template<class T> T& rawVector<T>::operator[](int idx)
+		template<class T, size_t Alignment, class Allocator> T& rawVector<T, Alignment, Allocator>::operator[](int idx)
 		{
 			return pointer[idx];
 		}
@@ -166,15 +426,23 @@ namespace Sys
 		 * Returns the number of elements in the array
 		 * @return integer
 		 */
-		template<class T> int rawVector<T>::getSize()
+		template<class T, size_t Alignment, class Allocator> int rawVector<T, Alignment, Allocator>::getSize()
 		{
 			return sz;
 		}
+		/**
+		 * Returns the number of elements which fit into the allocated memory without reallocation
+		 * @return integer
+		 */
+		template<class T, size_t Alignment, class Allocator> int rawVector<T, Alignment, Allocator>::getCapacity()
+		{
+			return cap;
+		}
 		/**
 		 * Returns a pointer to the first element in the array
 		 * @return pointer to first element
 		 */
-		template<class T> T* rawVector<T>::getPointer()
+		template<class T, size_t Alignment, class Allocator> T* rawVector<T, Alignment, Allocator>::getPointer()
 		{
 			return pointer;
 		}
@@ -182,14 +450,20 @@ namespace Sys
 		 * Removes all elements from the array
 		 * @return none
 		 */
-		template<class T> void rawVector<T>::clear()
+		template<class T, size_t Alignment, class Allocator> void rawVector<T, Alignment, Allocator>::clear()
 		{
-			if (pointer)
+			if (kind == MEMORY_FILE)
 			{
-				free(pointer);
+				unmapFile();
+			}
+			else if (pointer)
+			{
+				freeBlock(pointer, cap, kind);
 				pointer = NULL;
 			}
 			sz = 0;
+			cap = 0;
+			kind = MEMORY_ALLOCATOR;
 		}
 		/**
 		 * Writes the declared vector to the declared position in the array.
@@ -201,53 +475,477 @@ namespace Sys
 	     * @throw std::bad_alloc	- if memory allocation fails	
 		 * @return void
 		 */
-		template<class T> void rawVector<T>::setVector(int offset, const T *vec, int dim)
+		template<class T, size_t Alignment, class Allocator> void rawVector<T, Alignment, Allocator>::setVector(int offset, const T *vec, int dim)
 		{
-			bool result = false;
-			T *ptr;
-			int newSize;
+			if (readOnly)
+			{
+				throw std::logic_error("array is mapped read-only");
+			}
+			if (offset + dim > this->cap)
+			{
+				//array is not big enough at the moment, so we have to resize it
+				grow(offset + dim);
+			}
+			memcpy(this->pointer + offset, vec, dim * sizeof(T));
+			if (offset + dim > this->sz)
+			{
+				this->sz = offset + dim;
+			}
+		}
+		/**
+		 * Writes the elements of the declared view to the declared position in the array.
+		 * If neccessary the allocated memory region will be increased.
+		 * The view must not point into this array if the array grows.
+		 * @param offset			- offset in sizeof(T) steps
+		 * @param vec				- view of the elements which should be copied (any stride)
+	     * @throw std::bad_alloc	- if memory allocation fails
+		 * @return void
+		 */
+		template<class T, size_t Alignment, class Allocator> void rawVector<T, Alignment, Allocator>::setVector(int offset, rawVectorView<const T> vec)
+		{
+			if (vec.isContiguous())
+			{
+				setVector(offset, vec.getPointer(), vec.getSize());
+				return;
+			}
+			if (readOnly)
+			{
+				throw std::logic_error("array is mapped read-only");
+			}
+			int dim = vec.getSize();
+			if (offset + dim > this->cap)
+			{
+				grow(offset + dim);
+			}
+			T *dst = this->pointer + offset;
+			for (int i = 0; i < dim; i++)
+			{
+				dst[i] = vec[i];
+			}
+			if (offset + dim > this->sz)
+			{
+				this->sz = offset + dim;
+			}
+		}
+		/**
+		 * Returns a view of all elements (becomes invalid if the array is reallocated or freed)
+		 * @return view
+		 */
+		template<class T, size_t Alignment, class Allocator> rawVectorView<T> rawVector<T, Alignment, Allocator>::view()
+		{
+			return rawVectorView<T>(pointer, sz);
+		}
+		/**
+		 * Returns a view of a part of the array without copying (becomes invalid if the array is reallocated or freed)
+		 * @param offset			- index of the first element
+		 * @param count				- number of elements
+		 * @param step				- take every step-th element
+	     * @throw std::out_of_range	- if the range exceeds the array
+		 * @return view
+		 */
+		template<class T, size_t Alignment, class Allocator> rawVectorView<T> rawVector<T, Alignment, Allocator>::view(int offset, int count, int step)
+		{
+			return view().subview(offset, count, step);
+		}
+		/**
+		 * Appends the declared vector at the end of the array.
+		 * The capacity grows geometrically, so appending n elements costs amortized O(n).
+		 * @param *vec				- pointer to the vector which should be copied
+		 * @param dim				- number of elements of the vector which should be copied
+	     * @throw std::bad_alloc	- if memory allocation fails
+		 * @return void
+		 */
+		template<class T, size_t Alignment, class Allocator> void rawVector<T, Alignment, Allocator>::append(const T *vec, int dim)
+		{
+			setVector(this->sz, vec, dim);
+		}
+		/**
+		 * Appends one element at the end of the array
+		 * @param value				- element which should be appended
+	     * @throw std::bad_alloc	- if memory allocation fails
+		 * @return void
+		 */
+		template<class T, size_t Alignment, class Allocator> void rawVector<T, Alignment, Allocator>::push_back(const T &value)
+		{
+			if (this->sz == this->cap)
+			{
+				grow(this->sz + 1);
+			}
+			this->pointer[this->sz++] = value;
+		}
+		/**
+		 * Makes sure that at least the declared number of elements fit into the array without reallocation.
+		 * The size of the array is not changed.
+		 * @param capacity			- minimal capacity in elements
+	     * @throw std::bad_alloc	- if memory allocation fails
+		 * @return void
+		 */
+		template<class T, size_t Alignment, class Allocator> void rawVector<T, Alignment, Allocator>::reserve(int capacity)
+		{
+			if (capacity > this->cap)
+			{
+				reallocate(capacity);
+			}
+		}
+		/**
+		 * Frees the memory which is reserved but not used by elements
+	     * @throw std::bad_alloc	- if memory allocation fails
+		 * @return void
+		 */
+		template<class T, size_t Alignment, class Allocator> void rawVector<T, Alignment, Allocator>::shrink_to_fit()
+		{
+			if (this->kind == MEMORY_FILE)
+			{
+				//the file stays mapped (and open) even if it is empty
+				if (this->cap > this->sz)
+				{
+					reallocate(this->sz);
+				}
+			}
+			else if (this->sz == 0)
+			{
+				clear();
+			}
+			else if (this->cap > this->sz)
+			{
+				reallocate(this->sz);
+			}
+		}
+		/**
+		 * Sets the page mode which is used for the next (re)allocation of arrays of at least HUGE_PAGE_SIZE bytes.
+		 * Smaller arrays are always allocated on the heap.
+		 * @param mode				- PAGES_DEFAULT, PAGES_TRANSPARENT_HUGE or PAGES_EXPLICIT_HUGE
+		 * @return void
+		 */
+		template<class T, size_t Alignment, class Allocator> void rawVector<T, Alignment, Allocator>::setPageMode(PageMode mode)
+		{
+			this->pageMode = mode;
+		}
+		/**
+		 * Returns the page mode used for large arrays
+		 * @return PageMode
+		 */
+		template<class T, size_t Alignment, class Allocator> PageMode rawVector<T, Alignment, Allocator>::getPageMode()
+		{
+			return pageMode;
+		}
+		/**
+		 * Returns a copy of the allocator
+		 * @return Allocator
+		 */
+		template<class T, size_t Alignment, class Allocator> Allocator rawVector<T, Alignment, Allocator>::getAllocator()
+		{
+			return alloc;
+		}
+		/**
+		 * Replaces the content of the array with a shared memory mapping of the declared file.
+		 * The array has as many elements as fit completely into the file (in read-write mode the file size must be a
+		 * multiple of sizeof(T), so that no bytes are lost when the file grows). The file is mapped without reading it,
+		 * so arrays load instantly and processes which map the same file share the pages of the page cache.
+		 * In read-write mode setVector, append, push_back and reserve grow the file, clear() and the destructor
+		 * cut it back to the size of the array and close it.
+		 * @param *fileName				- path to the file
+		 * @param mode					- FILE_READONLY or FILE_READWRITE (creates the file if it does not exist)
+		 * @throw std::ios_base::failure	- if the file cannot be opened or mapped or its size does not fit (read-write mode)
+		 * @return void
+		 */
+		template<class T, size_t Alignment, class Allocator> void rawVector<T, Alignment, Allocator>::mapFile(const char *fileName, FileMode mode)
+		{
+#ifdef _RAWVECTOR_USE_MMAP
+			clear();
+			bool ro = (mode == FILE_READONLY);
+			int file = ro ? open(fileName, O_RDONLY) : open(fileName, O_RDWR | O_CREAT, 0644);
+			if (file < 0)
+			{
+				throw std::ios_base::failure("cannot open file");
+			}
+			struct stat st;
+			if ((fstat(file, &st) != 0) || ((unsigned long long)st.st_size / sizeof(T) > 0x7FFFFFFF))
+			{
+				close(file);
+				throw std::ios_base::failure("cannot map file");
+			}
+			if (!ro && ((unsigned long long)st.st_size % sizeof(T) != 0))
+			{
+				close(file);
+				throw std::ios_base::failure("file size is not a multiple of the element size");
+			}
+			int elements = (int)(st.st_size / sizeof(T));
+			fd = file;
+			readOnly = ro;
+			kind = MEMORY_FILE;
+			//set before mapping, so that clear() keeps the file size if the mapping fails
+			sz = elements;
+			try
+			{
+				mapFileRegion(elements);
+			}
+			catch (...)
+			{
+				clear();
+				throw;
+			}
+#else
+			throw std::ios_base::failure("memory mapped files are not supported");
+#endif
+		}
+		/**
+		 * Writes the changes of a file mapped in read-write mode back to the file and waits until they are done.
+		 * Does nothing for other arrays.
+		 * @throw std::ios_base::failure	- if writing fails
+		 * @return void
+		 */
+		template<class T, size_t Alignment, class Allocator> void rawVector<T, Alignment, Allocator>::sync()
+		{
+#ifdef _RAWVECTOR_USE_MMAP
+			if ((kind == MEMORY_FILE) && !readOnly && pointer)
+			{
+				if (msync((void*)pointer, (size_t)cap * sizeof(T), MS_SYNC) != 0)
+				{
+					throw std::ios_base::failure("cannot sync file");
+				}
+			}
+#endif
+		}
+		/**
+		 * Returns true if the array is a mapping of a file (see mapFile)
+		 * @return bool
+		 */
+		template<class T, size_t Alignment, class Allocator> bool rawVector<T, Alignment, Allocator>::isFileMapped()
+		{
+			return (kind == MEMORY_FILE);
+		}
+		#pragma endregion
+
+		#pragma region "Private Methods of class rawVector"
+		/**
+		 * Increases the capacity geometrically (by factor 1.5), but at least to the declared capacity
+		 * @param minCapacity		- capacity which is needed
+	     * @throw std::bad_alloc	- if memory allocation fails
+		 */
+		template<class T, size_t Alignment, class Allocator> void rawVector<T, Alignment, Allocator>::grow(int minCapacity)
+		{
+			//computed with 64 bits, cap + cap / 2 overflows int for arrays with more than 1.4 billion elements
+			long long newCap = (long long)this->cap + this->cap / 2;
+			if (newCap > INT_MAX)
+			{
+				newCap = INT_MAX;
+			}
+			if (newCap < minCapacity)
+			{
+				newCap = minCapacity;
+			}
+			reallocate((int)newCap);
+		}
+		/**
+		 * Changes the allocated memory to exactly the declared number of elements (must be >= size)
+		 * @param capacity			- new capacity in elements
+	     * @throw std::bad_alloc	- if memory allocation fails
+		 */
+		template<class T, size_t Alignment, class Allocator> void rawVector<T, Alignment, Allocator>::reallocate(int capacity)
+		{
+			if (this->kind == MEMORY_FILE)
+			{
+				//the file grows or shrinks with the array, so no copy is needed
+				if (readOnly)
+				{
+					throw std::logic_error("array is mapped read-only");
+				}
+				mapFileRegion(capacity);
+				return;
+			}
+			//realloc cannot be used because it does not keep the alignment
+			MemoryKind newKind;
+			T *ptr = allocBlock(capacity, newKind);
 			if (this->pointer)
 			{
-				if (offset + dim > this->sz)
+				_RAWVECTOR_RECORD(onReallocate());
+				memcpy(ptr, this->pointer, this->sz * sizeof(T));
+				freeBlock(this->pointer, this->cap, this->kind);
+			}
+			this->pointer = ptr;
+			this->cap = capacity;
+			this->kind = newKind;
+		}
+		/**
+		 * Allocates an aligned memory block for at least the declared number of elements.
+		 * Large blocks are mapped from the system if huge pages are requested,
+		 * in this case the capacity is increased to use the whole mapping.
+		 * Zeroed blocks of heapAllocator with at least LAZY_ZERO_SIZE bytes are mapped as well,
+		 * so the pages are only zeroed (and use physical memory) when they are touched the first time.
+		 * @param capacity			- number of elements, receives the real capacity
+		 * @param kind				- receives the origin of the memory block (needed to free it)
+		 * @param zero				- if true the block is filled with 0
+	     * @throw std::bad_alloc	- if memory allocation fails
+		 * @return pointer to the memory block
+		 */
+		template<class T, size_t Alignment, class Allocator> T* rawVector<T, Alignment, Allocator>::allocBlock(int &capacity, MemoryKind &kind, bool zero)
+		{
+			size_t bytes = (size_t)capacity * sizeof(T);
+#ifdef _RAWVECTOR_USE_MMAP
+			void *ptr = NULL;
+			if ((pageMode != PAGES_DEFAULT) && (bytes >= HUGE_PAGE_SIZE))
+			{
+				size_t len = mappedSize(bytes);
+#ifdef MAP_HUGETLB
+				if (pageMode == PAGES_EXPLICIT_HUGE)
 				{
-					//array is not big enough at the moment, so we have to resize it
-					newSize = (dim + offset);
-					ptr = (T*)realloc((void*)this->pointer, newSize * sizeof(T));
-					if (ptr)
+					ptr = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+					if (ptr != MAP_FAILED)
 					{
-						this->pointer = ptr;
-						ptr += offset;
-						memcpy(ptr, vec, sizeof(T) * dim);
-						this->sz = newSize;
-						result = true;
+						kind = MEMORY_HUGETLB;
+						capacity = (int)(len / sizeof(T));
+						_RAWVECTOR_RECORD(onAllocate(len));
+						return (T*)ptr;
 					}
 				}
-				else
+#endif
+				//map one huge page more than needed, so the block can start at a huge page boundary
+				char *raw = (char*)mmap(NULL, len + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+				if (raw == MAP_FAILED)
 				{
-					//array is already big enough
-					ptr = this->pointer + offset;
-					memcpy(ptr, vec, dim * sizeof(T));
-					result = true;
+					throw std::bad_alloc();
+				}
+				char *aligned = (char*)(((size_t)raw + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1));
+				if (aligned > raw)
+				{
+					munmap(raw, aligned - raw);
 				}
+				munmap(aligned + len, (raw + HUGE_PAGE_SIZE) - aligned);
+#ifdef MADV_HUGEPAGE
+				madvise(aligned, len, MADV_HUGEPAGE);
+#endif
+				kind = MEMORY_MAPPED;
+				capacity = (int)(len / sizeof(T));
+				_RAWVECTOR_RECORD(onAllocate(len));
+				return (T*)aligned;
 			}
-			else
+			if (zero && std::is_same<Allocator, heapAllocator>::value && (bytes >= LAZY_ZERO_SIZE) && (Alignment <= roundToPages(1)))
 			{
-				//array does not exist, so allocate new array
-				newSize = (dim + offset);
-				ptr = (T*)malloc(newSize * sizeof(T));
-				if (ptr)
+				//anonymous mappings are zero, unlike memset the pages are not touched now
+				ptr = mmap(NULL, roundToPages(bytes), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+				if (ptr == MAP_FAILED)
 				{
-					this->pointer = ptr;
-					ptr += offset;
-					memcpy(ptr, vec, sizeof(T) * dim);
-					this->sz = newSize;
-					result = true;
+					throw std::bad_alloc();
 				}
+				kind = MEMORY_ZEROED;
+				_RAWVECTOR_RECORD(onAllocate(roundToPages(bytes)));
+				return (T*)ptr;
 			}
-			if (result == false)
+#endif
+			kind = MEMORY_ALLOCATOR;
+			T *block = (T*)alloc.allocate(bytes, (Alignment < sizeof(void*)) ? sizeof(void*) : Alignment);
+			_RAWVECTOR_RECORD(onAllocate(bytes));
+			if (zero)
 			{
-				throw std::bad_alloc();
+				memset(block, 0, bytes);
 			}
+			return block;
+		}
+		/**
+		 * Frees a memory block which was allocated with allocBlock
+		 * @param *ptr				- pointer to the memory block
+		 * @param capacity			- capacity of the block in elements
+		 * @param kind				- origin of the memory block
+		 */
+		template<class T, size_t Alignment, class Allocator> void rawVector<T, Alignment, Allocator>::freeBlock(T *ptr, int capacity, MemoryKind kind)
+		{
+#ifdef _RAWVECTOR_USE_MMAP
+			if (kind != MEMORY_ALLOCATOR)
+			{
+				size_t len = (kind == MEMORY_ZEROED) ? roundToPages((size_t)capacity * sizeof(T)) : mappedSize((size_t)capacity * sizeof(T));
+				_RAWVECTOR_RECORD(onFree(len));
+				munmap((void*)ptr, len);
+				return;
+			}
+#endif
+			_RAWVECTOR_RECORD(onFree((size_t)capacity * sizeof(T)));
+			alloc.deallocate(ptr, (size_t)capacity * sizeof(T), (Alignment < sizeof(void*)) ? sizeof(void*) : Alignment);
+		}
+		/**
+		 * Resizes the mapped file (read-write mode) to the declared number of elements and maps it again.
+		 * The old mapping is only replaced if the new one succeeds, otherwise the array is not changed.
+		 * @param capacity				- new capacity in elements
+		 * @throw std::ios_base::failure	- if the file cannot be resized or mapped
+		 */
+		template<class T, size_t Alignment, class Allocator> void rawVector<T, Alignment, Allocator>::mapFileRegion(int capacity)
+		{
+#ifdef _RAWVECTOR_USE_MMAP
+			struct stat st;
+			if (!readOnly)
+			{
+				if ((fstat(fd, &st) != 0) || (ftruncate(fd, (off_t)capacity * sizeof(T)) != 0))
+				{
+					throw std::ios_base::failure("cannot resize file");
+				}
+			}
+			T *ptr = NULL;
+			if (capacity > 0)
+			{
+				void *mem = mmap(NULL, (size_t)capacity * sizeof(T), readOnly ? PROT_READ : (PROT_READ | PROT_WRITE), MAP_SHARED, fd, 0);
+				if (mem == MAP_FAILED)
+				{
+					//restore the old file size, so the old mapping stays completely backed by the file
+					if (!readOnly && (ftruncate(fd, st.st_size) != 0))
+					{
+						//nothing we can do here, the array keeps the old mapping
+					}
+					throw std::ios_base::failure("cannot map file");
+				}
+				ptr = (T*)mem;
+			}
+			if (pointer)
+			{
+				munmap((void*)pointer, (size_t)cap * sizeof(T));
+			}
+			pointer = ptr;
+			cap = capacity;
+#endif
+		}
+		/**
+		 * Unmaps the file, cuts it to the size of the array (read-write mode) and closes it
+		 */
+		template<class T, size_t Alignment, class Allocator> void rawVector<T, Alignment, Allocator>::unmapFile()
+		{
+#ifdef _RAWVECTOR_USE_MMAP
+			if (pointer)
+			{
+				munmap((void*)pointer, (size_t)cap * sizeof(T));
+				pointer = NULL;
+			}
+			if (fd >= 0)
+			{
+				if (!readOnly)
+				{
+					if (ftruncate(fd, (off_t)sz * sizeof(T)) != 0)
+					{
+						//nothing we can do here, the file keeps the reserved capacity
+					}
+				}
+				close(fd);
+				fd = -1;
+			}
+			readOnly = false;
+#endif
+		}
+		/**
+		 * Rounds the declared number of bytes up to a multiple of HUGE_PAGE_SIZE
+		 */
+		template<class T, size_t Alignment, class Allocator> size_t rawVector<T, Alignment, Allocator>::mappedSize(size_t bytes)
+		{
+			return (bytes + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+		}
+		/**
+		 * Rounds the declared number of bytes up to a multiple of the system page size
+		 */
+		template<class T, size_t Alignment, class Allocator> size_t rawVector<T, Alignment, Allocator>::roundToPages(size_t bytes)
+		{
+#ifdef _RAWVECTOR_USE_MMAP
+			static const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+			return (bytes + page - 1) & ~(page - 1);
+#else
+			return bytes;
+#endif
 		}
 		#pragma endregion
 	}
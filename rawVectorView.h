@@ -0,0 +1,153 @@
+/**
+ * @brief Non-owning view of a part of a raw array
+ *
+ * pointer, size and stride of a (sub)range, no memory is allocated or freed
+ *
+ * Licence: Released to the PUBLIC DOMAIN
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY OF ANY
+ * KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+ * PARTICULAR PURPOSE.
+ */
+#ifndef _RAWVECTORVIEW_H_
+#define _RAWVECTORVIEW_H_
+#include <assert.h>
+#include <stddef.h>
+#include <stdexcept>
+
+namespace Sys
+{
+	namespace Array
+	{
+		/**
+		 * Lightweight view of elements of a raw array (e.g. of a rawVector).
+		 * The view does not own the memory, it must not be used after the array was freed or reallocated.
+		 * Element i is located at pointer[i * stride], so a stride > 1 selects e.g. one column of a matrix.
+		 * Indexing is only bounds-checked in debug builds (assert).
+		 * Use rawVectorView<const T> for read-only access.
+		 */
+		template<class T> class rawVectorView
+		{
+		public:
+			inline rawVectorView();
+			inline rawVectorView(T *ptr, int dim, int stride = 1);
+			template<class U> inline rawVectorView(const rawVectorView<U> &view);
+			inline T& operator[](int idx) const;
+			inline int getSize() const;
+			inline int getStride() const;
+			inline T* getPointer() const;
+			inline bool isContiguous() const;
+			inline bool isEmpty() const;
+			inline rawVectorView subview(int offset, int count, int step = 1) const;
+		private:
+			T *pointer;
+			int sz;
+			int stride;
+		};
+
+		#pragma region "Public Methods of class rawVectorView"
+		/**
+		 * Initializes an empty view
+		 */
+		template<class T> rawVectorView<T>::rawVectorView()
+		{
+			pointer = NULL;
+			sz = 0;
+			stride = 1;
+		}
+		/**
+		 * Initializes a view of "dim" elements starting at ptr
+		 * @param *ptr		- pointer to the first element
+		 * @param dim		- number of elements
+		 * @param stride	- distance between two elements in sizeof(T) steps
+	     * @throw std::invalid_argument - if invalid pointer, size or stride
+		 */
+		template<class T> rawVectorView<T>::rawVectorView(T *ptr, int dim, int stride)
+		{
+			if ((dim < 0) || (stride < 1) || ((ptr == NULL) && (dim > 0)))
+			{
+				throw std::invalid_argument("invalid pointer, size or stride");
+			}
+			this->pointer = ptr;
+			this->sz = dim;
+			this->stride = stride;
+		}
+		/**
+		 * Converts a view to a view of a compatible type (e.g. rawVectorView<float> to rawVectorView<const float>)
+		 */
+		template<class T> template<class U> rawVectorView<T>::rawVectorView(const rawVectorView<U> &view)
+		{
+			pointer = view.getPointer();
+			sz = view.getSize();
+			stride = view.getStride();
+		}
+		/**
+		 * Returns the element at the declared index
+		 * @return reference to element of type T
+		 */
+		template<class T> T& rawVectorView<T>::operator[](int idx) const
+		{
+			assert((idx >= 0) && (idx < sz));
+			return pointer[(ptrdiff_t)idx * stride];
+		}
+		/**
+		 * Returns the number of elements in the view
+		 * @return integer
+		 */
+		template<class T> int rawVectorView<T>::getSize() const
+		{
+			return sz;
+		}
+		/**
+		 * Returns the distance between two elements in sizeof(T) steps
+		 * @return integer
+		 */
+		template<class T> int rawVectorView<T>::getStride() const
+		{
+			return stride;
+		}
+		/**
+		 * Returns a pointer to the first element
+		 * @return pointer to first element
+		 */
+		template<class T> T* rawVectorView<T>::getPointer() const
+		{
+			return pointer;
+		}
+		/**
+		 * Returns true if the elements are stored without gaps (stride 1)
+		 * @return bool
+		 */
+		template<class T> bool rawVectorView<T>::isContiguous() const
+		{
+			return (stride == 1);
+		}
+		/**
+		 * Returns true if the view has no elements
+		 * @return bool
+		 */
+		template<class T> bool rawVectorView<T>::isEmpty() const
+		{
+			return (sz == 0);
+		}
+		/**
+		 * Returns a view of a part of this view
+		 * @param offset	- index of the first element
+		 * @param count		- number of elements
+		 * @param step		- take every step-th element
+	     * @throw std::out_of_range - if the range exceeds the view
+		 * @return view
+		 */
+		template<class T> rawVectorView<T> rawVectorView<T>::subview(int offset, int count, int step) const
+		{
+			if ((offset < 0) || (count < 0) || (step < 1) || ((count > 0) && ((long long)offset + (long long)(count - 1) * step >= sz)))
+			{
+				throw std::out_of_range("subview exceeds the view");
+			}
+			return rawVectorView<T>((count > 0) ? pointer + (ptrdiff_t)offset * stride : pointer, count, stride * step);
+		}
+		#pragma endregion
+	}
+}
+#endif
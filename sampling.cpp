@@ -0,0 +1,89 @@
+/**
+* @brief sampling helpers based on the Random class
+*
+* alias table for weighted sampling, streaming reservoir sampling and in-place shuffling
+* The generated samples are not cryptographic secure!
+*
+* Usage:
+* THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY OF ANY
+* KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*/
+#include "sampling.h"
+namespace Sys
+{
+	namespace Misc
+	{
+		/**
+		* Builds the alias table of the declared distribution (Vose's method).
+		* The weights do not need to be normalized.
+		* @param *weights	- non negative weight of each index
+		* @param num		- number of weights
+		* @throw std::invalid_argument - if invalid pointer, size or weights
+		*/
+		AliasTable::AliasTable(const float *weights, int num)
+		{
+			if (weights == NULL)
+			{
+				throw std::invalid_argument("weights cannot be null!");
+			}
+			if (num <= 0)
+			{
+				throw std::invalid_argument("num cannot be less than 1!");
+			}
+			double sum = 0.0;
+			for (int i = 0; i < num; i++)
+			{
+				if (!(weights[i] >= 0.0f)) //also catches NaN
+				{
+					throw std::invalid_argument("weights cannot be negative!");
+				}
+				sum += weights[i];
+			}
+			if (sum <= 0.0)
+			{
+				throw std::invalid_argument("sum of weights cannot be 0!");
+			}
+
+			prob.resize(num);
+			alias.resize(num);
+			//scale the weights so the mean is 1.0 and split them into entries below and above the mean
+			std::vector<double> scaled(num);
+			std::vector<int> small, large;
+			for (int i = 0; i < num; i++)
+			{
+				scaled[i] = weights[i] * (double)num / sum;
+				if (scaled[i] < 1.0)
+					small.push_back(i);
+				else
+					large.push_back(i);
+			}
+			//each small entry gets filled up with the remaining probability of a large entry
+			while (!small.empty() && !large.empty())
+			{
+				int s = small.back(), l = large.back();
+				small.pop_back();
+				prob[s] = (float)scaled[s];
+				alias[s] = l;
+				scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+				if (scaled[l] < 1.0)
+				{
+					large.pop_back();
+					small.push_back(l);
+				}
+			}
+			//remaining entries are 1.0 (apart from rounding errors)
+			for (size_t i = 0; i < large.size(); i++)
+			{
+				prob[large[i]] = 1.0f;
+				alias[large[i]] = large[i];
+			}
+			for (size_t i = 0; i < small.size(); i++)
+			{
+				prob[small[i]] = 1.0f;
+				alias[small[i]] = small[i];
+			}
+		}
+	}
+}
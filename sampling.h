@@ -0,0 +1,177 @@
+/**
+* @brief sampling helpers based on the Random class
+*
+* alias table for weighted sampling, streaming reservoir sampling and in-place shuffling
+* The generated samples are not cryptographic secure!
+*
+* Usage:
+* THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY OF ANY
+* KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*/
+#ifndef _SAMPLING_H_
+#define _SAMPLING_H_
+
+#include <math.h>
+#include <stddef.h>
+#include <stdexcept>
+#include <vector>
+#include "random.h"
+
+namespace Sys
+{
+	namespace Misc
+	{
+		/**
+		* Draws indices from a fixed discrete distribution in O(1) per sample (Walker/Vose alias method).
+		* Building the table is O(n).
+		*/
+		class AliasTable
+		{
+		public:
+			AliasTable(const float *weights, int num);
+			inline int sample(Random &rnd);
+			inline int getSize();
+		private:
+			std::vector<float> prob;
+			std::vector<int> alias;
+		};
+
+		/**
+		* Keeps a uniform random subset of "k" elements of a stream of unknown length.
+		* Uses Li's algorithm L, so the number of random values needed is O(k * log(n / k)) instead of O(n).
+		*/
+		template<class T> class ReservoirSampler
+		{
+		public:
+			inline ReservoirSampler(size_t k, Random &rnd);
+			inline void add(const T &item);
+			inline void clear();
+			inline const std::vector<T>& getSamples();
+			inline unsigned long long getCount();
+		private:
+			inline void nextSkip();
+
+			std::vector<T> samples;
+			size_t k;
+			unsigned long long count, next;
+			double w;
+			Random &rnd;
+		};
+
+		template<class T> inline void shuffle(T *arr, size_t num, Random &rnd);
+
+		#pragma region "Inline Methods of class AliasTable"
+		/**
+		* returns a random index between 0 and getSize() - 1 with the probability of its weight
+		* @param rnd	- random number generator
+		*/
+		int AliasTable::sample(Random &rnd)
+		{
+			int idx = (int)rnd.getBounded((uint32_t)prob.size());
+			return (rnd.getFloat() < prob[idx]) ? idx : alias[idx];
+		}
+		/**
+		* returns the number of entries of the distribution
+		*/
+		int AliasTable::getSize()
+		{
+			return (int)prob.size();
+		}
+		#pragma endregion
+
+		#pragma region "Methods of class ReservoirSampler"
+		/**
+		* Creates an empty reservoir
+		* @param k		- maximal number of samples which will be kept
+		* @param rnd	- random number generator (must exist as long as the sampler)
+		* @throw std::invalid_argument - if k is 0
+		*/
+		template<class T> ReservoirSampler<T>::ReservoirSampler(size_t k, Random &rnd) : rnd(rnd)
+		{
+			if (k == 0)
+			{
+				throw std::invalid_argument("k cannot be less than 1!");
+			}
+			this->k = k;
+			samples.reserve(k);
+			clear();
+		}
+		/**
+		* Offers the next element of the stream to the reservoir
+		* @param item	- element of the stream
+		*/
+		template<class T> void ReservoirSampler<T>::add(const T &item)
+		{
+			if (count < k)
+			{
+				samples.push_back(item);
+				if (++count == k)
+				{
+					w = exp(log(1.0 - rnd.getDouble()) / (double)k);
+					nextSkip();
+				}
+				return;
+			}
+			if (count++ == next)
+			{
+				samples[rnd.getBounded((uint32_t)k)] = item;
+				w *= exp(log(1.0 - rnd.getDouble()) / (double)k);
+				nextSkip();
+			}
+		}
+		/**
+		* Removes all samples and starts a new stream
+		*/
+		template<class T> void ReservoirSampler<T>::clear()
+		{
+			samples.clear();
+			count = 0;
+			next = 0;
+			w = 1.0;
+		}
+		/**
+		* returns the current samples (less than k if the stream had less than k elements)
+		*/
+		template<class T> const std::vector<T>& ReservoirSampler<T>::getSamples()
+		{
+			return samples;
+		}
+		/**
+		* returns the number of elements seen so far
+		*/
+		template<class T> unsigned long long ReservoirSampler<T>::getCount()
+		{
+			return count;
+		}
+		/**
+		* calculates the stream position of the next element which will be put in the reservoir
+		*/
+		template<class T> void ReservoirSampler<T>::nextSkip()
+		{
+			//1.0 - getDouble() is in (0.0, 1.0], so the logarithm is finite
+			double skip = floor(log(1.0 - rnd.getDouble()) / log(1.0 - w));
+			next = count + ((skip < 1e18) ? (unsigned long long)skip : 1000000000000000000ULL);
+		}
+		#pragma endregion
+
+		/**
+		* Shuffles the array in place (Fisher-Yates), every permutation has the same probability
+		* @param *arr	- array which should be shuffled
+		* @param num	- number of elements (must be less than 2^32)
+		* @param rnd	- random number generator
+		*/
+		template<class T> void shuffle(T *arr, size_t num, Random &rnd)
+		{
+			for (size_t i = num; i > 1; i--)
+			{
+				size_t j = rnd.getBounded((uint32_t)i);
+				T tmp = arr[i - 1];
+				arr[i - 1] = arr[j];
+				arr[j] = tmp;
+			}
+		}
+	}
+}
+#endif
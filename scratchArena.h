@@ -0,0 +1,236 @@
+
+#ifndef _SCRATCHARENA_H_
+#define _SCRATCHARENA_H_
+
+#include <stddef.h>   // for size_t
+#include <new>
+#include "allocators.h" // for alignedAlloc
+
+#ifndef SCRATCHARENA_CHUNKSIZE
+#define SCRATCHARENA_CHUNKSIZE (1024 * 1024) // size of the chunks of the thread-local arena
+#endif
+
+/**
+* ScratchArena is a stack-like allocator for temporary arrays (frame allocator).
+* Allocations bump a pointer inside of a large chunk, they are not freed one by one but all at once
+* when the ScratchScope which was opened before them ends. Scopes can be nested, e.g. one per function of a call tree.
+* If a chunk is full a new chunk is added, chunks are kept for the next allocations, so after warm-up
+* whole call trees run without heap traffic.
+* Use ScratchArena::local() to get the arena of the calling thread. An arena must only be used by one thread.
+* The memory is not initialized and no constructors are called, use it for primitive types.
+*/
+class ScratchArena
+{
+public:
+	/**
+	* Position in the arena, allocations behind it are released by rewind()
+	*/
+	struct Marker
+	{
+		void *chunk;
+		char *current;
+	};
+
+	/**
+	* Creates an empty arena, memory is allocated on first use
+	* @param chunkSize      - size of the chunks requested from the heap
+	*/
+	explicit ScratchArena(size_t chunkSize = SCRATCHARENA_CHUNKSIZE)
+	{
+		this->chunkSize = chunkSize;
+		first = NULL;
+		chunk = NULL;
+		current = NULL;
+		end = NULL;
+	}
+	/**
+	* Frees all chunks
+	*/
+	~ScratchArena()
+	{
+		while (first)
+		{
+			chunkHeader *next = first->next;
+			Sys::Array::alignedFree(first);
+			first = next;
+		}
+	}
+	/**
+	* Returns the arena of the calling thread
+	*/
+	static inline ScratchArena& local()
+	{
+		static thread_local ScratchArena arena;
+		return arena;
+	}
+	/**
+	* Allocates uninitialized memory which is valid until the current scope ends
+	* @param bytes          - number of bytes
+	* @param alignment      - power of 2
+	* @throw std::bad_alloc - if allocation fails
+	*/
+	inline void* allocate(size_t bytes, size_t alignment = 64)
+	{
+		char *ptr = alignUp(current, alignment);
+		//with an alignment above the one of the chunk ptr can be behind the end of the chunk
+		if ((current == NULL) || (ptr > end) || (bytes > (size_t)(end - ptr)))
+		{
+			nextChunk(bytes, alignment);
+			ptr = alignUp(current, alignment);
+		}
+		current = ptr + bytes;
+		return ptr;
+	}
+	/**
+	* Allocates an uninitialized array of "count" elements which is valid until the current scope ends
+	* @throw std::bad_alloc - if allocation fails
+	*/
+	template <class T> inline T* allocArray(size_t count, size_t alignment = 64)
+	{
+		if (count > (size_t)-1 / sizeof(T))
+			throw std::bad_alloc();
+		return (T*)allocate(count * sizeof(T), (alignment < alignof(T)) ? alignof(T) : alignment);
+	}
+	/**
+	* Returns the current position
+	*/
+	inline Marker getMarker()
+	{
+		Marker mark;
+		mark.chunk = chunk;
+		mark.current = current;
+		return mark;
+	}
+	/**
+	* Releases all allocations which were made after the marker was taken (the chunks are kept)
+	*/
+	inline void rewind(const Marker &mark)
+	{
+		if (mark.chunk)
+		{
+			chunk = (chunkHeader*)mark.chunk;
+			current = mark.current;
+			end = (char*)chunk + chunk->size;
+		}
+		else if (first)
+		{
+			chunk = first;
+			current = (char*)(first + 1);
+			end = (char*)first + first->size;
+		}
+	}
+	/**
+	* Returns the number of bytes which are reserved from the heap
+	*/
+	size_t getReservedBytes()
+	{
+		size_t bytes = 0;
+		for (chunkHeader *c = first; c; c = c->next)
+			bytes += c->size;
+		return bytes;
+	}
+	/**
+	* Frees the chunks behind the current chunk (e.g. after a peak), must not be called while scopes use them
+	*/
+	void trim()
+	{
+		chunkHeader **link = chunk ? &chunk->next : &first;
+		while (*link)
+		{
+			chunkHeader *next = (*link)->next;
+			Sys::Array::alignedFree(*link);
+			*link = next;
+		}
+	}
+private:
+	//disallow copy and assign
+	ScratchArena(const ScratchArena&);
+	void operator=(const ScratchArena&);
+
+	struct chunkHeader
+	{
+		chunkHeader *next;
+		size_t size;
+		char padding[64 - sizeof(chunkHeader*) - sizeof(size_t)]; //keeps the payload 64 byte aligned
+	};
+	static inline char* alignUp(char *ptr, size_t alignment)
+	{
+		return (char*)(((size_t)ptr + alignment - 1) & ~(alignment - 1));
+	}
+	/**
+	* Continues in the next chunk which is big enough, a new chunk is inserted if there is none.
+	* Chunks are never moved, so memory of the outer scopes stays valid.
+	*/
+	void nextChunk(size_t bytes, size_t alignment)
+	{
+		size_t needed = bytes + alignment + sizeof(chunkHeader);
+		if (needed < bytes)
+			throw std::bad_alloc();
+		chunkHeader **link = chunk ? &chunk->next : &first;
+		//skip chunks which are too small for this request
+		while (*link && ((*link)->size < needed))
+			link = &(*link)->next;
+		if (*link == NULL)
+		{
+			size_t size = (needed < chunkSize) ? chunkSize : needed;
+			chunkHeader *c = (chunkHeader*)Sys::Array::alignedAlloc(size, 64);
+			c->next = NULL;
+			c->size = size;
+			*link = c;
+		}
+		chunk = *link;
+		current = (char*)(chunk + 1);
+		end = (char*)chunk + chunk->size;
+	}
+
+	size_t chunkSize;
+	chunkHeader *first;
+	chunkHeader *chunk; //chunk which is used at the moment
+	char *current, *end;
+};
+
+/**
+* ScratchScope releases all allocations of the arena which were made during its lifetime.
+* Usage:
+*   ScratchScope scope;                 //uses ScratchArena::local()
+*   float *tmp = scope.alloc<float>(n); //valid until scope ends
+*   int *idx = scope.alloc<int>(m);
+*/
+class ScratchScope
+{
+public:
+	/**
+	* Remembers the current position of the arena
+	*/
+	inline explicit ScratchScope(ScratchArena &arena = ScratchArena::local()) : arena(arena), mark(arena.getMarker())
+	{
+	}
+	/**
+	* Releases all allocations made since the construction
+	*/
+	inline ~ScratchScope()
+	{
+		arena.rewind(mark);
+	}
+	/**
+	* Allocates an uninitialized array of "count" elements
+	* @throw std::bad_alloc - if allocation fails
+	*/
+	template <class T> inline T* alloc(size_t count, size_t alignment = 64)
+	{
+		return arena.allocArray<T>(count, alignment);
+	}
+	inline ScratchArena& getArena()
+	{
+		return arena;
+	}
+private:
+	//disallow copy and assign
+	ScratchScope(const ScratchScope&);
+	void operator=(const ScratchScope&);
+
+	ScratchArena &arena;
+	ScratchArena::Marker mark;
+};
+
+#endif
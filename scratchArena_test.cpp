@@ -0,0 +1,89 @@
+/**
+* @brief tests for the ScratchArena allocator
+*
+* Checks alignment, nesting of scopes and allocations with alignments above the one of the chunks
+* near the end of a chunk. Build with -fsanitize=address to detect writes outside of the chunks.
+* Build: g++ -O2 -std=c++11 scratchArena_test.cpp -o scratchArena_test
+* The program returns 1 if at least one test failed.
+*
+* Usage:
+* THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY OF ANY
+* KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+* PARTICULAR PURPOSE.
+*/
+#include <stdio.h>
+#include <string.h>
+#include "scratchArena.h"
+
+static int failures = 0;
+
+static void check(const char *test, bool ok)
+{
+	if (!ok)
+		failures++;
+	printf("    %-48s %s\n", test, ok ? "PASS" : "FAIL");
+}
+
+/**
+* Fills a chunk up to a few bytes before its end and requests a block with a big alignment,
+* the block must be aligned and must not overlap the previous allocation
+*/
+static void testBigAlignment(size_t alignment)
+{
+	const size_t CHUNK = 4096 + 64; //payload of 4096 bytes behind the chunk header
+	ScratchArena arena(CHUNK);
+	char *a = (char*)arena.allocate(4096 - 8, 8);
+	memset(a, 0x55, 4096 - 8);
+	char *b = (char*)arena.allocate(16, alignment);
+	memset(b, 0xAA, 16);
+	bool ok = (((size_t)b & (alignment - 1)) == 0) && ((b >= a + 4096 - 8) || (b + 16 <= a));
+	for (size_t i = 0; i < 4096 - 8; i++)
+		ok = ok && (a[i] == 0x55);
+	char name[64];
+	snprintf(name, sizeof(name), "alignment %d near the end of a chunk", (int)alignment);
+	check(name, ok);
+}
+
+static void testScopes()
+{
+	ScratchArena arena(4096 + 64);
+	char *outer;
+	{
+		ScratchScope scope(arena);
+		outer = scope.alloc<char>(1000);
+		memset(outer, 1, 1000);
+		char *inner1;
+		{
+			ScratchScope inner(arena);
+			inner1 = inner.alloc<char>(10000); //needs a bigger chunk
+			memset(inner1, 2, 10000);
+		}
+		char *inner2;
+		{
+			ScratchScope inner(arena);
+			inner2 = inner.alloc<char>(10000);
+		}
+		check("rewound memory is reused", inner1 == inner2);
+		bool ok = true;
+		for (int i = 0; i < 1000; i++)
+			ok = ok && (outer[i] == 1);
+		check("outer allocation survives inner scopes", ok);
+	}
+	ScratchScope scope(arena);
+	check("arena is empty after the outermost scope", scope.alloc<char>(1000) == outer);
+	double *d = scope.alloc<double>(3, 1);
+	check("alignment is at least alignof(T)", ((size_t)d % alignof(double)) == 0);
+}
+
+int main()
+{
+	printf("ScratchArena\n");
+	testBigAlignment(128);
+	testBigAlignment(256);
+	testBigAlignment(4096);
+	testScopes();
+
+	printf("\n%d test(s) failed\n", failures);
+	return (failures > 0) ? 1 : 0;
+}
@@ -0,0 +1,424 @@
+/**
+ * @brief Segmented raw array for very large arrays
+ *
+ * dynamic raw array made of fixed-size chunks with size_t indexing
+ *
+ * Licence: Released to the PUBLIC DOMAIN
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY OF ANY
+ * KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+ * PARTICULAR PURPOSE.
+ */
+#ifndef _SEGMENTEDVECTOR_H_
+#define _SEGMENTEDVECTOR_H_
+#include <stdlib.h>
+#include <string.h>
+#include <stdexcept>
+#include <utility>
+#include "allocators.h"
+#include "rawVector.h"
+#include "rawVectorView.h"
+
+namespace Sys
+{
+	namespace Array
+	{
+		/**
+		 * Dynamic raw array which is stored in chunks of ChunkSize elements instead of one contiguous block.
+		 * The array grows by adding chunks, so existing elements are never copied and growing does not need
+		 * twice the memory (like the reallocation of rawVector does). Pointers to elements stay valid while the array grows.
+		 * Elements are indexed with size_t, so the array can hold more than 2^31 elements.
+		 * A chunk directory maps the index to the chunk in O(1) (ChunkSize is a power of 2, so this is a shift and a mask).
+		 * Use getChunk() or forEachChunk() to process the elements in contiguous blocks, e.g. with the functions of vectorMath.h.
+		 * Like rawVector this class DOES NOT CALL THE CONSTRUCTOR for elements, use it only with primitive types.
+		 */
+		template<class T, size_t ChunkSize = (1 << 20), class Allocator = heapAllocator> class segmentedVector
+		{
+			static_assert((ChunkSize > 0) && ((ChunkSize & (ChunkSize - 1)) == 0), "ChunkSize must be a power of 2");
+			static_assert(ChunkSize <= 0x40000000, "ChunkSize must fit into a rawVectorView");
+		public:
+			static const size_t CHUNKSIZE = ChunkSize;
+
+			segmentedVector();
+			explicit segmentedVector(const Allocator &alloc);
+			segmentedVector(size_t dim, const Allocator &alloc = Allocator());
+			segmentedVector(const segmentedVector&);
+			segmentedVector(segmentedVector&&) noexcept;
+			~segmentedVector();
+			void operator=(const segmentedVector&);
+			void operator=(segmentedVector&&) noexcept;
+			void swap(segmentedVector &arr) noexcept;
+			inline T& operator[](size_t idx);
+			inline size_t getSize();
+			inline size_t getCapacity();
+			inline size_t getChunkCount();
+			inline rawVectorView<T> getChunk(size_t chunk);
+			template<class Func> void forEachChunk(Func func);
+			void clear();
+			void setVector(size_t offset, const T *vec, size_t dim);
+			void getVector(size_t offset, T *vec, size_t dim);
+			void append(const T *vec, size_t dim);
+			inline void push_back(const T &value);
+			void resize(size_t dim);
+			void reserve(size_t capacity);
+			void shrink_to_fit();
+			inline Allocator getAllocator();
+		private:
+			void addChunks(size_t capacity);
+			void freeChunks(size_t count);
+
+			rawVector<T*> chunks; //chunk directory, only the pointers are copied when it grows
+			size_t sz;
+			Allocator alloc;
+		};
+
+		#pragma region "Public Methods of class segmentedVector"
+		/**
+		 * Initializes an empty array
+		 * @return - none
+		 */
+		template<class T, size_t ChunkSize, class Allocator> segmentedVector<T, ChunkSize, Allocator>::segmentedVector()
+		{
+			sz = 0;
+		}
+		/**
+		 * Initializes an empty array which takes its chunks from the declared allocator
+		 * @return - none
+		 */
+		template<class T, size_t ChunkSize, class Allocator> segmentedVector<T, ChunkSize, Allocator>::segmentedVector(const Allocator &alloc) : alloc(alloc)
+		{
+			sz = 0;
+		}
+		/**
+		 * Initializes an array with the declared dimension, all elements are zero
+	     * @throw std::bad_alloc - if memory allocation fails
+		 */
+		template<class T, size_t ChunkSize, class Allocator> segmentedVector<T, ChunkSize, Allocator>::segmentedVector(size_t dim, const Allocator &alloc) : alloc(alloc)
+		{
+			sz = 0;
+			resize(dim);
+		}
+		/**
+		 * create a copy of the declared array
+	     * @throw std::bad_alloc - if memory allocation fails
+		 */
+		template<class T, size_t ChunkSize, class Allocator> segmentedVector<T, ChunkSize, Allocator>::segmentedVector(const segmentedVector<T, ChunkSize, Allocator>& arr) : alloc(arr.alloc)
+		{
+			sz = 0;
+			(*this) = arr;
+		}
+		/**
+		 * Takes over the chunks of the declared array without copying, the declared array is empty afterwards
+		 * @return - none
+		 */
+		template<class T, size_t ChunkSize, class Allocator> segmentedVector<T, ChunkSize, Allocator>::segmentedVector(segmentedVector<T, ChunkSize, Allocator>&& arr) noexcept : chunks(std::move(arr.chunks)), alloc(arr.alloc)
+		{
+			sz = arr.sz;
+			arr.sz = 0;
+		}
+		/**
+		 * Frees reserved memory
+		 * @return - none
+		 */
+		template<class T, size_t ChunkSize, class Allocator> segmentedVector<T, ChunkSize, Allocator>::~segmentedVector()
+		{
+			clear();
+		}
+		/**
+		 * copy content of the array
+		 * @return					- none
+	     * @throw std::bad_alloc	- if memory allocation fails
+		 */
+		template<class T, size_t ChunkSize, class Allocator> void segmentedVector<T, ChunkSize, Allocator>::operator=(const segmentedVector<T, ChunkSize, Allocator>& arr)
+		{
+			if (this == &arr)
+			{
+				return;
+			}
+			clear();
+			addChunks(arr.sz);
+			for (size_t i = 0; i < arr.sz; i += ChunkSize)
+			{
+				size_t count = (arr.sz - i < ChunkSize) ? arr.sz - i : ChunkSize;
+				memcpy(chunks[(int)(i / ChunkSize)], const_cast<segmentedVector&>(arr).chunks[(int)(i / ChunkSize)], count * sizeof(T));
+			}
+			sz = arr.sz;
+		}
+		/**
+		 * Frees the own memory and takes over the chunks of the declared array without copying
+		 * @return - none
+		 */
+		template<class T, size_t ChunkSize, class Allocator> void segmentedVector<T, ChunkSize, Allocator>::operator=(segmentedVector<T, ChunkSize, Allocator>&& arr) noexcept
+		{
+			if (this != &arr)
+			{
+				clear();
+				swap(arr);
+			}
+		}
+		/**
+		 * Exchanges the content of both arrays without copying the elements
+		 * @return - none
+		 */
+		template<class T, size_t ChunkSize, class Allocator> void segmentedVector<T, ChunkSize, Allocator>::swap(segmentedVector<T, ChunkSize, Allocator> &arr) noexcept
+		{
+			chunks.swap(arr.chunks);
+			size_t tmpSz = sz; sz = arr.sz; arr.sz = tmpSz;
+			Allocator tmpAlloc = alloc; alloc = arr.alloc; arr.alloc = tmpAlloc;
+		}
+		/**
+		 * Returns the entry at the declared offset
+		 * @return reference to element of type T
+		 */
+		template<class T, size_t ChunkSize, class Allocator> T& segmentedVector<T, ChunkSize, Allocator>::operator[](size_t idx)
+		{
+			return chunks[(int)(idx / ChunkSize)][idx % ChunkSize];
+		}
+		/**
+		 * Returns the number of elements in the array
+		 * @return size_t
+		 */
+		template<class T, size_t ChunkSize, class Allocator> size_t segmentedVector<T, ChunkSize, Allocator>::getSize()
+		{
+			return sz;
+		}
+		/**
+		 * Returns the number of elements which fit into the allocated chunks
+		 * @return size_t
+		 */
+		template<class T, size_t ChunkSize, class Allocator> size_t segmentedVector<T, ChunkSize, Allocator>::getCapacity()
+		{
+			return (size_t)chunks.getSize() * ChunkSize;
+		}
+		/**
+		 * Returns the number of chunks which contain elements
+		 * @return size_t
+		 */
+		template<class T, size_t ChunkSize, class Allocator> size_t segmentedVector<T, ChunkSize, Allocator>::getChunkCount()
+		{
+			return (sz + ChunkSize - 1) / ChunkSize;
+		}
+		/**
+		 * Returns a view of the elements stored in the declared chunk.
+		 * All chunks except the last one contain ChunkSize elements.
+		 * @param chunk					- index of the chunk (0 ... getChunkCount() - 1)
+		 * @throw std::out_of_range		- if the chunk does not contain elements
+		 * @return contiguous view
+		 */
+		template<class T, size_t ChunkSize, class Allocator> rawVectorView<T> segmentedVector<T, ChunkSize, Allocator>::getChunk(size_t chunk)
+		{
+			if (chunk >= getChunkCount())
+			{
+				throw std::out_of_range("chunk index out of range");
+			}
+			size_t offset = chunk * ChunkSize;
+			size_t count = (sz - offset < ChunkSize) ? sz - offset : ChunkSize;
+			return rawVectorView<T>(chunks[(int)chunk], (int)count);
+		}
+		/**
+		 * Calls func(T *ptr, size_t count, size_t offset) for every chunk which contains elements.
+		 * ptr points to "count" contiguous elements which start at index "offset" of the array.
+		 * Example: forEachChunk([&](float *p, size_t n, size_t) { total += sum(p, n); });
+		 * @param func				- function or lambda
+		 * @return void
+		 */
+		template<class T, size_t ChunkSize, class Allocator> template<class Func> void segmentedVector<T, ChunkSize, Allocator>::forEachChunk(Func func)
+		{
+			for (size_t offset = 0; offset < sz; offset += ChunkSize)
+			{
+				size_t count = (sz - offset < ChunkSize) ? sz - offset : ChunkSize;
+				func(chunks[(int)(offset / ChunkSize)], count, offset);
+			}
+		}
+		/**
+		 * Removes all elements from the array and frees all chunks
+		 * @return none
+		 */
+		template<class T, size_t ChunkSize, class Allocator> void segmentedVector<T, ChunkSize, Allocator>::clear()
+		{
+			freeChunks(0);
+			sz = 0;
+		}
+		/**
+		 * Writes the declared vector to the declared position in the array.
+		 * If neccessary chunks are added, elements between the old end of the array and offset are zero.
+		 * @param offset			- offset in sizeof(T) steps
+		 * @param *vec				- pointer to the vector which should be copied
+		 * @param dim				- number of elements of the vector which should be copied
+	     * @throw std::bad_alloc	- if memory allocation fails
+		 * @return void
+		 */
+		template<class T, size_t ChunkSize, class Allocator> void segmentedVector<T, ChunkSize, Allocator>::setVector(size_t offset, const T *vec, size_t dim)
+		{
+			if (offset + dim < offset)
+			{
+				throw std::bad_alloc();
+			}
+			if (offset + dim > sz)
+			{
+				resize(offset + dim);
+			}
+			while (dim > 0)
+			{
+				size_t pos = offset % ChunkSize;
+				size_t count = (ChunkSize - pos < dim) ? ChunkSize - pos : dim;
+				memcpy(chunks[(int)(offset / ChunkSize)] + pos, vec, count * sizeof(T));
+				vec += count;
+				offset += count;
+				dim -= count;
+			}
+		}
+		/**
+		 * Copies elements of the array to the declared vector
+		 * @param offset				- index of the first element
+		 * @param *vec					- pointer to the destination
+		 * @param dim					- number of elements which should be copied
+		 * @throw std::out_of_range		- if the range exceeds the array
+		 * @return void
+		 */
+		template<class T, size_t ChunkSize, class Allocator> void segmentedVector<T, ChunkSize, Allocator>::getVector(size_t offset, T *vec, size_t dim)
+		{
+			if ((offset > sz) || (dim > sz - offset))
+			{
+				throw std::out_of_range("range exceeds the array");
+			}
+			while (dim > 0)
+			{
+				size_t pos = offset % ChunkSize;
+				size_t count = (ChunkSize - pos < dim) ? ChunkSize - pos : dim;
+				memcpy(vec, chunks[(int)(offset / ChunkSize)] + pos, count * sizeof(T));
+				vec += count;
+				offset += count;
+				dim -= count;
+			}
+		}
+		/**
+		 * Appends the declared vector at the end of the array
+		 * @param *vec				- pointer to the vector which should be copied
+		 * @param dim				- number of elements of the vector which should be copied
+	     * @throw std::bad_alloc	- if memory allocation fails
+		 * @return void
+		 */
+		template<class T, size_t ChunkSize, class Allocator> void segmentedVector<T, ChunkSize, Allocator>::append(const T *vec, size_t dim)
+		{
+			setVector(sz, vec, dim);
+		}
+		/**
+		 * Appends one element at the end of the array, a new chunk is added if the last one is full
+		 * @param value				- element which should be appended
+	     * @throw std::bad_alloc	- if memory allocation fails
+		 * @return void
+		 */
+		template<class T, size_t ChunkSize, class Allocator> void segmentedVector<T, ChunkSize, Allocator>::push_back(const T &value)
+		{
+			if (sz == getCapacity())
+			{
+				addChunks(sz + 1);
+			}
+			chunks[(int)(sz / ChunkSize)][sz % ChunkSize] = value;
+			sz++;
+		}
+		/**
+		 * Changes the number of elements, new elements are zero.
+		 * Chunks which are not needed anymore are kept (see shrink_to_fit).
+		 * @param dim				- new number of elements
+	     * @throw std::bad_alloc	- if memory allocation fails
+		 * @return void
+		 */
+		template<class T, size_t ChunkSize, class Allocator> void segmentedVector<T, ChunkSize, Allocator>::resize(size_t dim)
+		{
+			addChunks(dim);
+			for (size_t i = sz; i < dim; )
+			{
+				size_t pos = i % ChunkSize;
+				size_t count = (ChunkSize - pos < dim - i) ? ChunkSize - pos : dim - i;
+				memset(chunks[(int)(i / ChunkSize)] + pos, 0, count * sizeof(T));
+				i += count;
+			}
+			sz = dim;
+		}
+		/**
+		 * Makes sure that at least the declared number of elements fit into the allocated chunks.
+		 * The size of the array is not changed.
+		 * @param capacity			- minimal capacity in elements
+	     * @throw std::bad_alloc	- if memory allocation fails
+		 * @return void
+		 */
+		template<class T, size_t ChunkSize, class Allocator> void segmentedVector<T, ChunkSize, Allocator>::reserve(size_t capacity)
+		{
+			addChunks(capacity);
+		}
+		/**
+		 * Frees the chunks which do not contain elements
+	     * @throw std::bad_alloc	- if the smaller chunk directory cannot be allocated
+		 * @return void
+		 */
+		template<class T, size_t ChunkSize, class Allocator> void segmentedVector<T, ChunkSize, Allocator>::shrink_to_fit()
+		{
+			freeChunks(getChunkCount());
+		}
+		/**
+		 * Returns a copy of the allocator
+		 * @return Allocator
+		 */
+		template<class T, size_t ChunkSize, class Allocator> Allocator segmentedVector<T, ChunkSize, Allocator>::getAllocator()
+		{
+			return alloc;
+		}
+		#pragma endregion
+
+		#pragma region "Private Methods of class segmentedVector"
+		/**
+		 * Adds chunks until at least the declared number of elements fit into the array
+		 * @param capacity			- capacity which is needed
+	     * @throw std::bad_alloc	- if memory allocation fails
+		 */
+		template<class T, size_t ChunkSize, class Allocator> void segmentedVector<T, ChunkSize, Allocator>::addChunks(size_t capacity)
+		{
+			size_t needed = capacity / ChunkSize + ((capacity % ChunkSize) ? 1 : 0);
+			if (needed > 0x7FFFFFFF)
+			{
+				throw std::bad_alloc();
+			}
+			while ((size_t)chunks.getSize() < needed)
+			{
+				T *chunk = (T*)alloc.allocate(ChunkSize * sizeof(T), 64);
+				try
+				{
+					chunks.push_back(chunk);
+				}
+				catch (...)
+				{
+					alloc.deallocate(chunk, ChunkSize * sizeof(T), 64);
+					throw;
+				}
+			}
+		}
+		/**
+		 * Frees all chunks behind the declared number of chunks
+		 * @param count				- number of chunks which are kept
+	     * @throw std::bad_alloc	- if the smaller chunk directory cannot be allocated
+		 */
+		template<class T, size_t ChunkSize, class Allocator> void segmentedVector<T, ChunkSize, Allocator>::freeChunks(size_t count)
+		{
+			int keep = (int)count;
+			if (chunks.getSize() <= keep)
+			{
+				return;
+			}
+			rawVector<T*> dir;
+			if (keep > 0)
+			{
+				dir.append(chunks.getPointer(), keep); //copied first, so nothing is freed if this fails
+			}
+			for (int i = keep; i < chunks.getSize(); i++)
+			{
+				alloc.deallocate(chunks[i], ChunkSize * sizeof(T), 64);
+			}
+			chunks = std::move(dir);
+		}
+		#pragma endregion
+	}
+}
+#endif
@@ -0,0 +1,430 @@
+
+#ifndef _SMALLVECTOR_H_
+#define _SMALLVECTOR_H_
+
+#include <stddef.h>   // for size_t
+#include <string.h>   // for memcpy
+#include <new>
+#include <utility>
+#include <type_traits>
+#include <initializer_list>
+#include "stackPtr.h" // for StackPtrCache
+
+/**
+* SmallVector is a growable array which keeps up to N elements in an inline buffer (on the stack if the SmallVector is).
+* Like StackPtr it does not allocate as long as the inline buffer is big enough, but the size does not need to be known
+* in advance: when more than N elements are added the elements are moved to the heap and the capacity grows
+* geometrically (by factor 1.5). Heap blocks come from the StackPtrCache of the thread.
+* Only the used elements are constructed. Pointers to elements become invalid when the capacity changes.
+*/
+template <class T, size_t N> class SmallVector
+{
+	static_assert(N > 0, "N must be at least 1");
+public:
+	/**
+	* Creates an empty vector which uses the inline buffer
+	*/
+	inline SmallVector() : ptr(inlineData()), sz(0), cap(N)
+	{
+	}
+	/**
+	* Creates a vector with "size" value-initialized elements
+	* @throw std::bad_alloc - if allocation fails
+	*/
+	explicit SmallVector(size_t size) : ptr(inlineData()), sz(0), cap(N)
+	{
+		resize(size);
+	}
+	/**
+	* Creates a vector with a copy of the declared elements
+	* @throw std::bad_alloc - if allocation fails
+	*/
+	SmallVector(std::initializer_list<T> list) : ptr(inlineData()), sz(0), cap(N)
+	{
+		reserve(list.size());
+		for (const T *it = list.begin(); it != list.end(); ++it)
+			new (ptr + sz++) T(*it);
+	}
+	/**
+	* Creates a copy of the declared vector
+	* @throw std::bad_alloc - if allocation fails
+	*/
+	SmallVector(const SmallVector &vec) : ptr(inlineData()), sz(0), cap(N)
+	{
+		copyFrom(vec);
+	}
+	/**
+	* Takes over the elements of the declared vector, the heap block is taken over without moving the elements.
+	* The declared vector is empty afterwards. Inline elements are moved, so this only throws if T's move
+	* constructor can throw (then the declared vector keeps its elements).
+	*/
+	SmallVector(SmallVector &&vec) noexcept(std::is_nothrow_move_constructible<T>::value) : ptr(inlineData()), sz(0), cap(N)
+	{
+		takeOver(vec);
+	}
+	/**
+	* Destroys the elements and frees the heap block
+	*/
+	~SmallVector()
+	{
+		clear();
+		freeHeap();
+	}
+	/**
+	* Replaces the content by a copy of the declared vector
+	* @throw std::bad_alloc - if allocation fails
+	*/
+	SmallVector& operator=(const SmallVector &vec)
+	{
+		if (this != &vec)
+		{
+			clear();
+			copyFrom(vec);
+		}
+		return *this;
+	}
+	/**
+	* Replaces the content by the elements of the declared vector, the declared vector is empty afterwards
+	*/
+	SmallVector& operator=(SmallVector &&vec) noexcept(std::is_nothrow_move_constructible<T>::value)
+	{
+		if (this != &vec)
+		{
+			clear();
+			freeHeap();
+			takeOver(vec);
+		}
+		return *this;
+	}
+	/**
+	* Provides random access to elements
+	*/
+	inline T& operator[](size_t idx)
+	{
+		return ptr[idx];
+	}
+	inline const T& operator[](size_t idx) const
+	{
+		return ptr[idx];
+	}
+	/**
+	* Provides the number of elements
+	*/
+	inline size_t size() const
+	{
+		return sz;
+	}
+	/**
+	* Provides the number of elements which fit into the vector without reallocation (at least N)
+	*/
+	inline size_t capacity() const
+	{
+		return cap;
+	}
+	inline bool empty() const
+	{
+		return sz == 0;
+	}
+	/**
+	* Returns true as long as the elements are stored in the inline buffer
+	*/
+	inline bool isInline() const
+	{
+		return ptr == inlineData();
+	}
+	inline T* data()
+	{
+		return ptr;
+	}
+	inline const T* data() const
+	{
+		return ptr;
+	}
+	inline T* begin()
+	{
+		return ptr;
+	}
+	inline T* end()
+	{
+		return ptr + sz;
+	}
+	inline const T* begin() const
+	{
+		return ptr;
+	}
+	inline const T* end() const
+	{
+		return ptr + sz;
+	}
+	inline T& back()
+	{
+		return ptr[sz - 1];
+	}
+	/**
+	* Appends one element
+	* @throw std::bad_alloc - if allocation fails
+	*/
+	inline void push_back(const T &value)
+	{
+		if (sz == cap)
+		{
+			T tmp(value); //value may be an element of this vector
+			grow(sz + 1);
+			new (ptr + sz) T(std::move(tmp));
+		}
+		else
+		{
+			new (ptr + sz) T(value);
+		}
+		sz++;
+	}
+	inline void push_back(T &&value)
+	{
+		if (sz == cap)
+		{
+			T tmp(std::move(value));
+			grow(sz + 1);
+			new (ptr + sz) T(std::move(tmp));
+		}
+		else
+		{
+			new (ptr + sz) T(std::move(value));
+		}
+		sz++;
+	}
+	/**
+	* Constructs one element at the end with the declared constructor arguments
+	* @throw std::bad_alloc - if allocation fails
+	*/
+	template <class... Args> inline T& emplace_back(Args&&... args)
+	{
+		if (sz == cap)
+		{
+			//the arguments may refer to elements of this vector, so the new element is constructed
+			//in the new block before the old elements are moved and the old block is freed
+			size_t newCap = cap + cap / 2;
+			if (newCap < sz + 1)
+				newCap = sz + 1;
+			if (newCap > (size_t)-1 / sizeof(T))
+				throw std::bad_alloc();
+			T *mem = (T*)StackPtrCache::allocate(newCap * sizeof(T));
+			try
+			{
+				new (mem + sz) T(std::forward<Args>(args)...);
+			}
+			catch (...)
+			{
+				StackPtrCache::deallocate(mem, newCap * sizeof(T));
+				throw;
+			}
+			try
+			{
+				relocate(mem, ptr, sz);
+			}
+			catch (...)
+			{
+				mem[sz].~T();
+				StackPtrCache::deallocate(mem, newCap * sizeof(T));
+				throw;
+			}
+			freeHeap();
+			ptr = mem;
+			cap = newCap;
+		}
+		else
+		{
+			new (ptr + sz) T(std::forward<Args>(args)...);
+		}
+		return ptr[sz++];
+	}
+	/**
+	* Removes the last element
+	*/
+	inline void pop_back()
+	{
+		ptr[--sz].~T();
+	}
+	/**
+	* Changes the number of elements, new elements are value-initialized (0 for primitive types)
+	* @throw std::bad_alloc - if allocation fails
+	*/
+	void resize(size_t size)
+	{
+		if (size > cap)
+			grow(size);
+		while (sz < size)
+		{
+			new (ptr + sz) T();
+			sz++;
+		}
+		while (sz > size)
+			pop_back();
+	}
+	/**
+	* Changes the number of elements, new elements are copies of "value"
+	* @throw std::bad_alloc - if allocation fails
+	*/
+	void resize(size_t size, const T &value)
+	{
+		if (size > cap)
+		{
+			T tmp(value);
+			grow(size);
+			while (sz < size)
+			{
+				new (ptr + sz) T(tmp);
+				sz++;
+			}
+		}
+		while (sz < size)
+		{
+			new (ptr + sz) T(value);
+			sz++;
+		}
+		while (sz > size)
+			pop_back();
+	}
+	/**
+	* Makes sure that at least "capacity" elements fit into the vector without reallocation
+	* @throw std::bad_alloc - if allocation fails
+	*/
+	void reserve(size_t capacity)
+	{
+		if (capacity > cap)
+			reallocate(capacity);
+	}
+	/**
+	* Removes all elements, the capacity is kept
+	*/
+	void clear()
+	{
+		if (!std::is_trivially_destructible<T>::value)
+		{
+			for (size_t i = sz; i > 0; i--)
+				ptr[i - 1].~T();
+		}
+		sz = 0;
+	}
+private:
+	inline T* inlineData()
+	{
+		return reinterpret_cast<T*>(&buffer[0]);
+	}
+	inline const T* inlineData() const
+	{
+		return reinterpret_cast<const T*>(&buffer[0]);
+	}
+	/**
+	* Increases the capacity geometrically (by factor 1.5), but at least to the declared capacity
+	*/
+	void grow(size_t minCapacity)
+	{
+		size_t newCap = cap + cap / 2;
+		reallocate((newCap < minCapacity) ? minCapacity : newCap);
+	}
+	/**
+	* Moves the elements into a new heap block of the declared capacity (must be >= size)
+	*/
+	void reallocate(size_t capacity)
+	{
+		if (capacity > (size_t)-1 / sizeof(T))
+			throw std::bad_alloc();
+		T *mem = (T*)StackPtrCache::allocate(capacity * sizeof(T));
+		try
+		{
+			relocate(mem, ptr, sz);
+		}
+		catch (...)
+		{
+			StackPtrCache::deallocate(mem, capacity * sizeof(T));
+			throw;
+		}
+		freeHeap();
+		ptr = mem;
+		cap = capacity;
+	}
+	/**
+	* Moves "count" elements to uninitialized memory and destroys the source elements.
+	* Elements whose move constructor can throw are copied if possible (like std::vector). If an element
+	* cannot be constructed, the new elements are destroyed and the source elements are kept
+	* (elements which can only be moved by a throwing move constructor may be left in a moved-from state).
+	*/
+	static void relocate(T *dst, T *src, size_t count)
+	{
+		if (std::is_trivially_copyable<T>::value)
+		{
+			if (count)
+				memcpy((void*)dst, (const void*)src, count * sizeof(T));
+			return;
+		}
+		size_t i = 0;
+		try
+		{
+			for (; i < count; i++)
+				new (dst + i) T(std::move_if_noexcept(src[i]));
+		}
+		catch (...)
+		{
+			while (i > 0)
+				dst[--i].~T();
+			throw;
+		}
+		for (i = 0; i < count; i++)
+			src[i].~T();
+	}
+	/**
+	* Copies the elements of vec (this vector must be empty)
+	*/
+	void copyFrom(const SmallVector &vec)
+	{
+		reserve(vec.sz);
+		if (std::is_trivially_copyable<T>::value)
+		{
+			if (vec.sz)
+				memcpy((void*)ptr, (const void*)vec.ptr, vec.sz * sizeof(T));
+			sz = vec.sz;
+			return;
+		}
+		for (size_t i = 0; i < vec.sz; i++)
+		{
+			new (ptr + i) T(vec.ptr[i]);
+			sz++;
+		}
+	}
+	void freeHeap()
+	{
+		if (!isInline())
+		{
+			StackPtrCache::deallocate(ptr, cap * sizeof(T));
+			ptr = inlineData();
+			cap = N;
+		}
+	}
+	/**
+	* Takes over the elements of vec (this vector must be empty and inline)
+	*/
+	void takeOver(SmallVector &vec)
+	{
+		if (vec.isInline())
+		{
+			relocate(ptr, vec.ptr, vec.sz);
+			sz = vec.sz;
+		}
+		else
+		{
+			ptr = vec.ptr;
+			sz = vec.sz;
+			cap = vec.cap;
+			vec.ptr = vec.inlineData();
+			vec.cap = N;
+		}
+		vec.sz = 0;
+	}
+
+	alignas(T) unsigned char buffer[N * sizeof(T)]; //raw memory, no constructor is called
+	T* ptr;
+	size_t sz;
+	size_t cap;
+};
+
+#endif
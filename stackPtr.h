@@ -4,6 +4,131 @@
 //#define _USE_STACKPTR_ALLOWALLOCATOR
 
 #include <stddef.h>   // for size_t
+#include <new>         // for placement new
+#include <type_traits> // for std::is_trivially_destructible
+#include "allocators.h" // for alignedAlloc and sizeClasses
+
+#ifdef _USE_ALLOC_TELEMETRY
+#include "allocTelemetry.h" // counts constructions and heap fallbacks per StackPtr<T, maxStack>
+#define _STACKPTR_RECORD(call) Sys::Array::getAllocRecord<Sys::Array::stackPtrTag<maxStack>, T>("StackPtr", maxStack).call
+#else
+#define _STACKPTR_RECORD(call)
+#endif
+
+#ifndef STACKPTR_CACHE_MAXBYTES
+#define STACKPTR_CACHE_MAXBYTES (4 * 1024 * 1024) // bytes which each thread keeps in its cache at most
+#endif
+
+/**
+* Per-thread cache for the heap memory of StackPtr.
+* Freed blocks are kept in a free list of their size class (power of 2, 64 bytes ... 1 MB) and reused by the
+* next StackPtr of the same thread, so spills in loops do not go to the global heap (and do not contend for its locks).
+* Each thread keeps at most STACKPTR_CACHE_MAXBYTES bytes, blocks above 1 MB are not cached.
+* All blocks are aligned to 64 bytes.
+* The cache of a thread is freed when the thread exits.
+*/
+class StackPtrCache
+{
+public:
+	static const size_t MINCLASS = Sys::Array::sizeClasses::MINSIZE;
+	static const size_t MAXCLASS = Sys::Array::sizeClasses::MAXSIZE;
+	static const int NUMCLASSES = Sys::Array::sizeClasses::COUNT;
+	static const size_t ALIGNMENT = 64; //alignment of all blocks
+
+	/**
+	* Returns a block of at least the declared size from the cache of the calling thread or from the heap
+	* @throw std::bad_alloc - if allocation fails
+	*/
+	static inline void* allocate(size_t bytes)
+	{
+		if (bytes > MAXCLASS)
+			return Sys::Array::alignedAlloc(bytes, ALIGNMENT);
+		int cls = Sys::Array::sizeClasses::index(bytes);
+		threadCache &cache = local();
+		freeBlock *block = cache.freeList[cls];
+		if (block)
+		{
+			cache.freeList[cls] = block->next;
+			cache.cachedBytes -= Sys::Array::sizeClasses::size(cls);
+			return block;
+		}
+		return Sys::Array::alignedAlloc(Sys::Array::sizeClasses::size(cls), ALIGNMENT);
+	}
+	/**
+	* Puts the block into the cache of the calling thread, if the cache is full it is given back to the heap
+	*/
+	static inline void deallocate(void *ptr, size_t bytes)
+	{
+		if (bytes > MAXCLASS)
+		{
+			Sys::Array::alignedFree(ptr);
+			return;
+		}
+		int cls = Sys::Array::sizeClasses::index(bytes);
+		threadCache &cache = local();
+		if (cache.cachedBytes + Sys::Array::sizeClasses::size(cls) > STACKPTR_CACHE_MAXBYTES)
+		{
+			Sys::Array::alignedFree(ptr);
+			return;
+		}
+		freeBlock *block = (freeBlock*)ptr;
+		block->next = cache.freeList[cls];
+		cache.freeList[cls] = block;
+		cache.cachedBytes += Sys::Array::sizeClasses::size(cls);
+	}
+	/**
+	* Gives all blocks of the calling thread back to the heap
+	*/
+	static inline void trim()
+	{
+		local().release();
+	}
+	/**
+	* Returns the number of bytes in the cache of the calling thread
+	*/
+	static inline size_t getCachedBytes()
+	{
+		return local().cachedBytes;
+	}
+private:
+	struct freeBlock
+	{
+		freeBlock *next;
+	};
+	struct threadCache
+	{
+		freeBlock *freeList[NUMCLASSES];
+		size_t cachedBytes;
+
+		threadCache() : cachedBytes(0)
+		{
+			for (int i = 0; i < NUMCLASSES; i++)
+				freeList[i] = NULL;
+		}
+		~threadCache()
+		{
+			release();
+		}
+		void release()
+		{
+			for (int i = 0; i < NUMCLASSES; i++)
+			{
+				while (freeList[i])
+				{
+					freeBlock *next = freeList[i]->next;
+					Sys::Array::alignedFree(freeList[i]);
+					freeList[i] = next;
+				}
+			}
+			cachedBytes = 0;
+		}
+	};
+	static inline threadCache& local()
+	{
+		static thread_local threadCache cache;
+		return cache;
+	}
+};
 
 #ifdef _USE_STACKPTR_ALLOWALLOCATOR
 #include <memory>
@@ -13,10 +138,13 @@ using namespace std;
 * To improve allocation speed it reserves "maxStack" elements on the Stack.
 * If the requested amout is smaller or equal to "maxStack" a pointer to the stack is delivered.
 * If the amount is bigger then the memory will be allocated on the heap.
+* The stack buffer is raw memory aligned to "Alignment" bytes (64 by default, for aligned SIMD loads),
+* only the "size" requested elements are constructed (default-initialized) and destroyed.
 * StackPtr automatically frees the memory in the destructor.
 */
-template <class T, size_t maxStack, class _myAlloc = allocator<T> > class StackPtr
+template <class T, size_t maxStack, class _myAlloc = allocator<T>, size_t Alignment = 64> class StackPtr
 {
+	static_assert((Alignment & (Alignment - 1)) == 0, "Alignment must be a power of 2");
 public:
 	/**
 	* Allocates memory of the declared amout on the stack or if there is not enought room on the heap
@@ -26,15 +154,30 @@ public:
 	inline StackPtr(size_t size)
 	{
 		sz = size;
-		ptr = (size > maxStack) ? alloc.allocate(size) : &data[0];
+		ptr = (size > maxStack) ? alloc.allocate(size) : (T*)&data[0];
+		try
+		{
+			construct(ptr, size);
+		}
+		catch (...)
+		{
+			if (ptr != (T*)&data[0])
+				alloc.deallocate(ptr, sz);
+			throw;
+		}
+		_STACKPTR_RECORD(onStackPtr(size, size * sizeof(T), size > maxStack));
 	}
 	/**
 	* Free reserved memory
 	*/
 	inline ~StackPtr()
 	{
-		if (ptr != &data[0])
+		destroy(ptr, sz);
+		if (ptr != (T*)&data[0])
+		{
+			_STACKPTR_RECORD(onFree(sz * sizeof(T)));
 			alloc.deallocate(ptr, sz);
+		}
 	}
 	/**
 	* Provides random access to elements
@@ -55,8 +198,34 @@ private:
 	StackPtr(const StackPtr&);               
 	void operator=(const StackPtr&);
 
-	T data[maxStack];
-	_myAlloc::pointer ptr;
+	/**
+	* Default-initializes "size" elements, already constructed elements are destroyed if a constructor throws
+	*/
+	static void construct(T *mem, size_t size)
+	{
+		size_t i = 0;
+		try
+		{
+			for (; i < size; i++)
+				new (mem + i) T;
+		}
+		catch (...)
+		{
+			destroy(mem, i);
+			throw;
+		}
+	}
+	static inline void destroy(T *mem, size_t size)
+	{
+		if (!std::is_trivially_destructible<T>::value)
+		{
+			for (size_t i = size; i > 0; i--)
+				mem[i - 1].~T();
+		}
+	}
+
+	alignas((Alignment < alignof(T)) ? alignof(T) : Alignment) unsigned char data[maxStack * sizeof(T)]; //raw memory, no constructor is called
+	typename _myAlloc::pointer ptr;
 	_myAlloc alloc;
 	size_t sz;
 };
@@ -67,11 +236,15 @@ private:
 * StackPtr can be used to dynamically allocate memory.
 * To improve allocation speed it reserves "maxStack" elements on the Stack.
 * If the requested amount is smaller or equal to "maxStack" a pointer to the stack is delivered.
-* If the amout is bigger then the memory will be allocated on the heap.
+* If the amout is bigger then the memory will be taken from the StackPtrCache of the thread (or the heap).
+* The stack buffer is raw memory aligned to "Alignment" bytes (64 by default, for aligned SIMD loads),
+* only the "size" requested elements are constructed (default-initialized) and destroyed.
+* So a big maxStack costs nothing at construction. Heap blocks are aligned as well.
 * StackPtr automatically frees the memory in the destructor.
 */
-template <class T, size_t maxStack> class StackPtr
+template <class T, size_t maxStack, size_t Alignment = 64> class StackPtr
 {
+	static_assert((Alignment & (Alignment - 1)) == 0, "Alignment must be a power of 2");
 public:
 	/**
 	* Allocates memory of the declared amout on the stack or if there is not enought room on the heap
@@ -80,15 +253,31 @@ public:
 	*/
 	inline StackPtr(size_t size)
 	{
-		ptr = (size > maxStack) ? new T[size] : &data[0];
+		sz = size;
+		ptr = (size > maxStack) ? allocate(size) : (T*)&data[0];
+		try
+		{
+			construct(ptr, size);
+		}
+		catch (...)
+		{
+			if (ptr != (T*)&data[0])
+				deallocate(ptr, size);
+			throw;
+		}
+		_STACKPTR_RECORD(onStackPtr(size, size * sizeof(T), size > maxStack));
 	}
 	/**
 	* Free reserved memory
 	*/
 	inline ~StackPtr()
 	{
-		if (ptr != &data[0])
-			delete [] ptr;
+		destroy(ptr, sz);
+		if (ptr != (T*)&data[0])
+		{
+			_STACKPTR_RECORD(onFree(sz * sizeof(T)));
+			deallocate(ptr, sz);
+		}
 	}
 	/**
 	* Provides random access to elements
@@ -102,8 +291,53 @@ private:
 	StackPtr(const StackPtr&);               
 	void operator=(const StackPtr&);
 
-	T data[maxStack];
+	/**
+	* Takes a block from the cache (blocks of the cache are 64 byte aligned, bigger alignments bypass it)
+	*/
+	static T* allocate(size_t size)
+	{
+		if (size > (size_t)-1 / sizeof(T))
+			throw std::bad_alloc();
+		if (Alignment > StackPtrCache::ALIGNMENT)
+			return (T*)Sys::Array::alignedAlloc(size * sizeof(T), Alignment);
+		return (T*)StackPtrCache::allocate(size * sizeof(T));
+	}
+	static void deallocate(T *mem, size_t size)
+	{
+		if (Alignment > StackPtrCache::ALIGNMENT)
+			Sys::Array::alignedFree(mem);
+		else
+			StackPtrCache::deallocate(mem, size * sizeof(T));
+	}
+	/**
+	* Default-initializes "size" elements like new T[size], already constructed elements are destroyed if a constructor throws
+	*/
+	static void construct(T *mem, size_t size)
+	{
+		size_t i = 0;
+		try
+		{
+			for (; i < size; i++)
+				new (mem + i) T;
+		}
+		catch (...)
+		{
+			destroy(mem, i);
+			throw;
+		}
+	}
+	static inline void destroy(T *mem, size_t size)
+	{
+		if (!std::is_trivially_destructible<T>::value)
+		{
+			for (size_t i = size; i > 0; i--)
+				mem[i - 1].~T();
+		}
+	}
+
+	alignas((Alignment < alignof(T)) ? alignof(T) : Alignment) unsigned char data[maxStack * sizeof(T)]; //raw memory, no constructor is called
 	T* ptr;
+	size_t sz;
 };
 
 #endif
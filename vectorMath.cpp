@@ -0,0 +1,436 @@
+/**
+ * @brief vectorized element-wise operations and reductions
+ *
+ * The kernels in vectorMathKernels.inl are compiled once for every instruction set,
+ * the fastest version supported by the CPU is selected on first use.
+ *
+ * Licence: Released to the PUBLIC DOMAIN
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY OF ANY
+ * KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+ * PARTICULAR PURPOSE.
+ */
+#include "vectorMath.h"
+
+//clang ignores "#pragma GCC target", so the SIMD kernels are only compiled with GCC
+#if defined(__GNUC__) && !defined(__clang__) && (defined(__x86_64__) || defined(__i386__))
+#define _VECTORMATH_USE_X86
+//the AVX-512 intrinsics of GCC 12 initialize their undefined pass-through operands with themselves,
+//which triggers false -Wuninitialized warnings where they are inlined
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#pragma GCC diagnostic pop
+#endif
+
+namespace Sys
+{
+	namespace Array
+	{
+		namespace
+		{
+			#pragma region "scalar"
+			namespace scalar
+			{
+				template<class Type, class Result> struct traits
+				{
+					typedef Type T;
+					typedef Type V;
+					typedef Result R;
+					typedef Result A;
+					static const size_t W = 1;
+					static inline V load(const T *p) { return *p; }
+					static inline void store(T *p, V v) { *p = v; }
+					static inline V set1(T v) { return v; }
+					static inline V mul(V a, V b) { return smadd(a, b, (T)0); }
+					static inline V madd(V a, V b, V c) { return smadd(a, b, c); }
+					static inline V vmin(V a, V b) { return (b < a) ? b : a; }
+					static inline V vmax(V a, V b) { return (b > a) ? b : a; }
+					static inline T hmin(V v) { return v; }
+					static inline T hmax(V v) { return v; }
+					static inline A accZero() { return 0; }
+					static inline A accAdd(A acc, V v) { return acc + (R)v; }
+					static inline A accDot(A acc, V a, V b) { return acc + (R)a * (R)b; }
+					static inline A accMerge(A a, A b) { return a + b; }
+					static inline R accReduce(A acc) { return acc; }
+					static inline T smadd(T a, T b, T c) { return a * b + c; }
+				};
+				//integer overflow wraps around like in the vector code
+				template<> inline int32_t traits<int32_t, long long>::smadd(int32_t a, int32_t b, int32_t c)
+				{
+					return (int32_t)((uint32_t)a * (uint32_t)b + (uint32_t)c);
+				}
+				#include "vectorMathKernels.inl"
+			}
+			#pragma endregion
+
+#ifdef _VECTORMATH_USE_X86
+			#pragma region "AVX2"
+			#pragma GCC push_options
+			#pragma GCC target("avx2,fma")
+			namespace avx2
+			{
+				struct floatTraits
+				{
+					typedef float T;
+					typedef __m256 V;
+					typedef float R;
+					typedef __m256 A;
+					static const size_t W = 8;
+					static inline V load(const T *p) { return _mm256_loadu_ps(p); }
+					static inline void store(T *p, V v) { _mm256_storeu_ps(p, v); }
+					static inline V set1(T v) { return _mm256_set1_ps(v); }
+					static inline V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+					static inline V madd(V a, V b, V c) { return _mm256_fmadd_ps(a, b, c); }
+					static inline V vmin(V a, V b) { return _mm256_min_ps(a, b); }
+					static inline V vmax(V a, V b) { return _mm256_max_ps(a, b); }
+					static inline T hmin(V v)
+					{
+						__m128 m = _mm_min_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+						m = _mm_min_ps(m, _mm_movehl_ps(m, m));
+						m = _mm_min_ss(m, _mm_shuffle_ps(m, m, 1));
+						return _mm_cvtss_f32(m);
+					}
+					static inline T hmax(V v)
+					{
+						__m128 m = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+						m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+						m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+						return _mm_cvtss_f32(m);
+					}
+					static inline A accZero() { return _mm256_setzero_ps(); }
+					static inline A accAdd(A acc, V v) { return _mm256_add_ps(acc, v); }
+					static inline A accDot(A acc, V a, V b) { return _mm256_fmadd_ps(a, b, acc); }
+					static inline A accMerge(A a, A b) { return _mm256_add_ps(a, b); }
+					static inline R accReduce(A acc)
+					{
+						__m128 s = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+						s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+						s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+						return _mm_cvtss_f32(s);
+					}
+					static inline T smadd(T a, T b, T c) { return a * b + c; }
+				};
+				struct doubleTraits
+				{
+					typedef double T;
+					typedef __m256d V;
+					typedef double R;
+					typedef __m256d A;
+					static const size_t W = 4;
+					static inline V load(const T *p) { return _mm256_loadu_pd(p); }
+					static inline void store(T *p, V v) { _mm256_storeu_pd(p, v); }
+					static inline V set1(T v) { return _mm256_set1_pd(v); }
+					static inline V mul(V a, V b) { return _mm256_mul_pd(a, b); }
+					static inline V madd(V a, V b, V c) { return _mm256_fmadd_pd(a, b, c); }
+					static inline V vmin(V a, V b) { return _mm256_min_pd(a, b); }
+					static inline V vmax(V a, V b) { return _mm256_max_pd(a, b); }
+					static inline T hmin(V v)
+					{
+						__m128d m = _mm_min_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+						m = _mm_min_sd(m, _mm_unpackhi_pd(m, m));
+						return _mm_cvtsd_f64(m);
+					}
+					static inline T hmax(V v)
+					{
+						__m128d m = _mm_max_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+						m = _mm_max_sd(m, _mm_unpackhi_pd(m, m));
+						return _mm_cvtsd_f64(m);
+					}
+					static inline A accZero() { return _mm256_setzero_pd(); }
+					static inline A accAdd(A acc, V v) { return _mm256_add_pd(acc, v); }
+					static inline A accDot(A acc, V a, V b) { return _mm256_fmadd_pd(a, b, acc); }
+					static inline A accMerge(A a, A b) { return _mm256_add_pd(a, b); }
+					static inline R accReduce(A acc)
+					{
+						__m128d s = _mm_add_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+						s = _mm_add_sd(s, _mm_unpackhi_pd(s, s));
+						return _mm_cvtsd_f64(s);
+					}
+					static inline T smadd(T a, T b, T c) { return a * b + c; }
+				};
+				struct int32Traits
+				{
+					typedef int32_t T;
+					typedef __m256i V;
+					typedef long long R;
+					typedef __m256i A; //four 64 bit sums
+					static const size_t W = 8;
+					static inline V load(const T *p) { return _mm256_loadu_si256((const __m256i*)p); }
+					static inline void store(T *p, V v) { _mm256_storeu_si256((__m256i*)p, v); }
+					static inline V set1(T v) { return _mm256_set1_epi32(v); }
+					static inline V mul(V a, V b) { return _mm256_mullo_epi32(a, b); }
+					static inline V madd(V a, V b, V c) { return _mm256_add_epi32(_mm256_mullo_epi32(a, b), c); }
+					static inline V vmin(V a, V b) { return _mm256_min_epi32(a, b); }
+					static inline V vmax(V a, V b) { return _mm256_max_epi32(a, b); }
+					static inline T hmin(V v)
+					{
+						__m128i m = _mm_min_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+						m = _mm_min_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+						m = _mm_min_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+						return _mm_cvtsi128_si32(m);
+					}
+					static inline T hmax(V v)
+					{
+						__m128i m = _mm_max_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+						m = _mm_max_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+						m = _mm_max_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+						return _mm_cvtsi128_si32(m);
+					}
+					static inline A accZero() { return _mm256_setzero_si256(); }
+					static inline A accAdd(A acc, V v)
+					{
+						//sign extend both halves to 64 bit
+						acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+						return _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+					}
+					static inline A accDot(A acc, V a, V b)
+					{
+						//_mm256_mul_epi32 multiplies the even elements to 64 bit, the odd ones are shifted down first
+						acc = _mm256_add_epi64(acc, _mm256_mul_epi32(a, b));
+						return _mm256_add_epi64(acc, _mm256_mul_epi32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32)));
+					}
+					static inline A accMerge(A a, A b) { return _mm256_add_epi64(a, b); }
+					static inline R accReduce(A acc)
+					{
+						long long s[4];
+						_mm256_storeu_si256((__m256i*)s, acc);
+						return s[0] + s[1] + s[2] + s[3];
+					}
+					static inline T smadd(T a, T b, T c) { return (int32_t)((uint32_t)a * (uint32_t)b + (uint32_t)c); }
+				};
+				#include "vectorMathKernels.inl"
+			}
+			#pragma GCC pop_options
+			#pragma endregion
+
+			#pragma region "AVX-512"
+			#pragma GCC push_options
+			#pragma GCC target("avx512f,fma")
+			namespace avx512
+			{
+				struct floatTraits
+				{
+					typedef float T;
+					typedef __m512 V;
+					typedef float R;
+					typedef __m512 A;
+					static const size_t W = 16;
+					static inline V load(const T *p) { return _mm512_loadu_ps(p); }
+					static inline void store(T *p, V v) { _mm512_storeu_ps(p, v); }
+					static inline V set1(T v) { return _mm512_set1_ps(v); }
+					static inline V mul(V a, V b) { return _mm512_mul_ps(a, b); }
+					static inline V madd(V a, V b, V c) { return _mm512_fmadd_ps(a, b, c); }
+					static inline V vmin(V a, V b) { return _mm512_min_ps(a, b); }
+					static inline V vmax(V a, V b) { return _mm512_max_ps(a, b); }
+					static inline T hmin(V v) { return _mm512_reduce_min_ps(v); }
+					static inline T hmax(V v) { return _mm512_reduce_max_ps(v); }
+					static inline A accZero() { return _mm512_setzero_ps(); }
+					static inline A accAdd(A acc, V v) { return _mm512_add_ps(acc, v); }
+					static inline A accDot(A acc, V a, V b) { return _mm512_fmadd_ps(a, b, acc); }
+					static inline A accMerge(A a, A b) { return _mm512_add_ps(a, b); }
+					static inline R accReduce(A acc) { return _mm512_reduce_add_ps(acc); }
+					static inline T smadd(T a, T b, T c) { return a * b + c; }
+				};
+				struct doubleTraits
+				{
+					typedef double T;
+					typedef __m512d V;
+					typedef double R;
+					typedef __m512d A;
+					static const size_t W = 8;
+					static inline V load(const T *p) { return _mm512_loadu_pd(p); }
+					static inline void store(T *p, V v) { _mm512_storeu_pd(p, v); }
+					static inline V set1(T v) { return _mm512_set1_pd(v); }
+					static inline V mul(V a, V b) { return _mm512_mul_pd(a, b); }
+					static inline V madd(V a, V b, V c) { return _mm512_fmadd_pd(a, b, c); }
+					static inline V vmin(V a, V b) { return _mm512_min_pd(a, b); }
+					static inline V vmax(V a, V b) { return _mm512_max_pd(a, b); }
+					static inline T hmin(V v) { return _mm512_reduce_min_pd(v); }
+					static inline T hmax(V v) { return _mm512_reduce_max_pd(v); }
+					static inline A accZero() { return _mm512_setzero_pd(); }
+					static inline A accAdd(A acc, V v) { return _mm512_add_pd(acc, v); }
+					static inline A accDot(A acc, V a, V b) { return _mm512_fmadd_pd(a, b, acc); }
+					static inline A accMerge(A a, A b) { return _mm512_add_pd(a, b); }
+					static inline R accReduce(A acc) { return _mm512_reduce_add_pd(acc); }
+					static inline T smadd(T a, T b, T c) { return a * b + c; }
+				};
+				struct int32Traits
+				{
+					typedef int32_t T;
+					typedef __m512i V;
+					typedef long long R;
+					typedef __m512i A; //eight 64 bit sums
+					static const size_t W = 16;
+					static inline V load(const T *p) { return _mm512_loadu_si512((const void*)p); }
+					static inline void store(T *p, V v) { _mm512_storeu_si512((void*)p, v); }
+					static inline V set1(T v) { return _mm512_set1_epi32(v); }
+					static inline V mul(V a, V b) { return _mm512_mullo_epi32(a, b); }
+					static inline V madd(V a, V b, V c) { return _mm512_add_epi32(_mm512_mullo_epi32(a, b), c); }
+					static inline V vmin(V a, V b) { return _mm512_min_epi32(a, b); }
+					static inline V vmax(V a, V b) { return _mm512_max_epi32(a, b); }
+					static inline T hmin(V v) { return _mm512_reduce_min_epi32(v); }
+					static inline T hmax(V v) { return _mm512_reduce_max_epi32(v); }
+					static inline A accZero() { return _mm512_setzero_si512(); }
+					static inline A accAdd(A acc, V v)
+					{
+						acc = _mm512_add_epi64(acc, _mm512_cvtepi32_epi64(_mm512_castsi512_si256(v)));
+						return _mm512_add_epi64(acc, _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(v, 1)));
+					}
+					static inline A accDot(A acc, V a, V b)
+					{
+						acc = _mm512_add_epi64(acc, _mm512_mul_epi32(a, b));
+						return _mm512_add_epi64(acc, _mm512_mul_epi32(_mm512_srli_epi64(a, 32), _mm512_srli_epi64(b, 32)));
+					}
+					static inline A accMerge(A a, A b) { return _mm512_add_epi64(a, b); }
+					static inline R accReduce(A acc) { return _mm512_reduce_add_epi64(acc); }
+					static inline T smadd(T a, T b, T c) { return (int32_t)((uint32_t)a * (uint32_t)b + (uint32_t)c); }
+				};
+				#include "vectorMathKernels.inl"
+			}
+			#pragma GCC pop_options
+			#pragma endregion
+#endif
+
+			#pragma region "runtime dispatch"
+			enum simdLevel { SIMD_SCALAR, SIMD_AVX2, SIMD_AVX512 };
+			/**
+			 * detects the best instruction set supported by the CPU (and the operating system)
+			 */
+			simdLevel detectSimdLevel()
+			{
+#ifdef _VECTORMATH_USE_X86
+				__builtin_cpu_init();
+				if (__builtin_cpu_supports("avx512f"))
+					return SIMD_AVX512;
+				if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+					return SIMD_AVX2;
+#endif
+				return SIMD_SCALAR;
+			}
+			simdLevel getLevel()
+			{
+				static const simdLevel level = detectSimdLevel();
+				return level;
+			}
+			//table of the kernels of one element type
+			template<class T, class R> struct kernelTable
+			{
+				R (*sum)(const T*, size_t);
+				R (*dot)(const T*, const T*, size_t);
+				void (*axpy)(T, const T*, T*, size_t);
+				void (*scale)(T, T*, size_t);
+				T (*minValue)(const T*, size_t);
+				T (*maxValue)(const T*, size_t);
+				void (*multiplyAdd)(const T*, const T*, const T*, T*, size_t);
+			};
+			template<class K, class T, class R> kernelTable<T, R> makeTable()
+			{
+				kernelTable<T, R> table = { &K::sum, &K::dot, &K::axpy, &K::scale, &K::minValue, &K::maxValue, &K::multiplyAdd };
+				return table;
+			}
+			template<class T, class R, class KScalar, class KAvx2, class KAvx512> kernelTable<T, R> selectTable()
+			{
+				switch (getLevel())
+				{
+				case SIMD_AVX512:
+					return makeTable<KAvx512, T, R>();
+				case SIMD_AVX2:
+					return makeTable<KAvx2, T, R>();
+				default:
+					return makeTable<KScalar, T, R>();
+				}
+			}
+#ifdef _VECTORMATH_USE_X86
+			const kernelTable<float, float>& floatKernels()
+			{
+				static const kernelTable<float, float> table = selectTable<float, float, scalar::kernels<scalar::traits<float, float> >, avx2::kernels<avx2::floatTraits>, avx512::kernels<avx512::floatTraits> >();
+				return table;
+			}
+			const kernelTable<double, double>& doubleKernels()
+			{
+				static const kernelTable<double, double> table = selectTable<double, double, scalar::kernels<scalar::traits<double, double> >, avx2::kernels<avx2::doubleTraits>, avx512::kernels<avx512::doubleTraits> >();
+				return table;
+			}
+			const kernelTable<int32_t, long long>& int32Kernels()
+			{
+				static const kernelTable<int32_t, long long> table = selectTable<int32_t, long long, scalar::kernels<scalar::traits<int32_t, long long> >, avx2::kernels<avx2::int32Traits>, avx512::kernels<avx512::int32Traits> >();
+				return table;
+			}
+#else
+			const kernelTable<float, float>& floatKernels()
+			{
+				static const kernelTable<float, float> table = makeTable<scalar::kernels<scalar::traits<float, float> >, float, float>();
+				return table;
+			}
+			const kernelTable<double, double>& doubleKernels()
+			{
+				static const kernelTable<double, double> table = makeTable<scalar::kernels<scalar::traits<double, double> >, double, double>();
+				return table;
+			}
+			const kernelTable<int32_t, long long>& int32Kernels()
+			{
+				static const kernelTable<int32_t, long long> table = makeTable<scalar::kernels<scalar::traits<int32_t, long long> >, int32_t, long long>();
+				return table;
+			}
+#endif
+			#pragma endregion
+		}
+
+		#pragma region "Public functions"
+		/**
+		 * returns the instruction set which is used: "avx512", "avx2" or "scalar"
+		 */
+		const char* getSimdLevel()
+		{
+			switch (getLevel())
+			{
+			case SIMD_AVX512:
+				return "avx512";
+			case SIMD_AVX2:
+				return "avx2";
+			default:
+				return "scalar";
+			}
+		}
+		float sum(const float *x, size_t n) { return floatKernels().sum(x, n); }
+		double sum(const double *x, size_t n) { return doubleKernels().sum(x, n); }
+		long long sum(const int32_t *x, size_t n) { return int32Kernels().sum(x, n); }
+
+		float dot(const float *x, const float *y, size_t n) { return floatKernels().dot(x, y, n); }
+		double dot(const double *x, const double *y, size_t n) { return doubleKernels().dot(x, y, n); }
+		long long dot(const int32_t *x, const int32_t *y, size_t n) { return int32Kernels().dot(x, y, n); }
+
+		void axpy(float alpha, const float *x, float *y, size_t n) { floatKernels().axpy(alpha, x, y, n); }
+		void axpy(double alpha, const double *x, double *y, size_t n) { doubleKernels().axpy(alpha, x, y, n); }
+		void axpy(int32_t alpha, const int32_t *x, int32_t *y, size_t n) { int32Kernels().axpy(alpha, x, y, n); }
+
+		void scale(float alpha, float *x, size_t n) { floatKernels().scale(alpha, x, n); }
+		void scale(double alpha, double *x, size_t n) { doubleKernels().scale(alpha, x, n); }
+		void scale(int32_t alpha, int32_t *x, size_t n) { int32Kernels().scale(alpha, x, n); }
+
+		/**
+		 * throws std::invalid_argument for empty arrays (minimum and maximum are not defined)
+		 */
+		static inline void checkNotEmpty(size_t n)
+		{
+			if (n == 0)
+			{
+				throw std::invalid_argument("array cannot be empty");
+			}
+		}
+		float minValue(const float *x, size_t n) { checkNotEmpty(n); return floatKernels().minValue(x, n); }
+		double minValue(const double *x, size_t n) { checkNotEmpty(n); return doubleKernels().minValue(x, n); }
+		int32_t minValue(const int32_t *x, size_t n) { checkNotEmpty(n); return int32Kernels().minValue(x, n); }
+		float maxValue(const float *x, size_t n) { checkNotEmpty(n); return floatKernels().maxValue(x, n); }
+		double maxValue(const double *x, size_t n) { checkNotEmpty(n); return doubleKernels().maxValue(x, n); }
+		int32_t maxValue(const int32_t *x, size_t n) { checkNotEmpty(n); return int32Kernels().maxValue(x, n); }
+
+		void multiplyAdd(const float *a, const float *b, const float *c, float *out, size_t n) { floatKernels().multiplyAdd(a, b, c, out, n); }
+		void multiplyAdd(const double *a, const double *b, const double *c, double *out, size_t n) { doubleKernels().multiplyAdd(a, b, c, out, n); }
+		void multiplyAdd(const int32_t *a, const int32_t *b, const int32_t *c, int32_t *out, size_t n) { int32Kernels().multiplyAdd(a, b, c, out, n); }
+		#pragma endregion
+	}
+}
@@ -0,0 +1,156 @@
+/**
+ * @brief vectorized element-wise operations and reductions
+ *
+ * sum, dot product, axpy, scale, minimum/maximum and multiply-add for float, double and int32_t arrays.
+ * The best implementation for the CPU (AVX-512, AVX2 or scalar) is selected at runtime.
+ *
+ * Licence: Released to the PUBLIC DOMAIN
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY OF ANY
+ * KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+ * PARTICULAR PURPOSE.
+ */
+#ifndef _VECTORMATH_H_
+#define _VECTORMATH_H_
+#include <stddef.h>
+#include <stdint.h>
+#include <stdexcept>
+#include "rawVector.h"
+#include "rawVectorView.h"
+
+namespace Sys
+{
+	namespace Array
+	{
+		//returns the instruction set which is used: "avx512", "avx2" or "scalar"
+		const char* getSimdLevel();
+
+		//sum of all elements (int32_t values are summed up as 64 bit integers)
+		float sum(const float *x, size_t n);
+		double sum(const double *x, size_t n);
+		long long sum(const int32_t *x, size_t n);
+
+		//dot product x * y
+		float dot(const float *x, const float *y, size_t n);
+		double dot(const double *x, const double *y, size_t n);
+		long long dot(const int32_t *x, const int32_t *y, size_t n);
+
+		//y = alpha * x + y
+		void axpy(float alpha, const float *x, float *y, size_t n);
+		void axpy(double alpha, const double *x, double *y, size_t n);
+		void axpy(int32_t alpha, const int32_t *x, int32_t *y, size_t n);
+
+		//x = alpha * x
+		void scale(float alpha, float *x, size_t n);
+		void scale(double alpha, double *x, size_t n);
+		void scale(int32_t alpha, int32_t *x, size_t n);
+
+		//smallest and largest element, throw std::invalid_argument if n is 0
+		float minValue(const float *x, size_t n);
+		double minValue(const double *x, size_t n);
+		int32_t minValue(const int32_t *x, size_t n);
+		float maxValue(const float *x, size_t n);
+		double maxValue(const double *x, size_t n);
+		int32_t maxValue(const int32_t *x, size_t n);
+
+		//out = a * b + c (fused for float and double if the CPU supports it), out may be one of the inputs
+		void multiplyAdd(const float *a, const float *b, const float *c, float *out, size_t n);
+		void multiplyAdd(const double *a, const double *b, const double *c, double *out, size_t n);
+		void multiplyAdd(const int32_t *a, const int32_t *b, const int32_t *c, int32_t *out, size_t n);
+
+		#pragma region "rawVector and rawVectorView versions"
+		/**
+		 * returns the sum of all elements of the array
+		 */
+		template<class T, size_t Alignment, class Allocator> inline auto sum(rawVector<T, Alignment, Allocator> &x) -> decltype(sum((const T*)NULL, 0))
+		{
+			return sum(x.getPointer(), (size_t)x.getSize());
+		}
+		/**
+		 * returns the dot product of both arrays
+		 * @throw std::invalid_argument - if the sizes differ
+		 */
+		template<class T, size_t Alignment, class Allocator> inline auto dot(rawVector<T, Alignment, Allocator> &x, rawVector<T, Alignment, Allocator> &y) -> decltype(dot((const T*)NULL, (const T*)NULL, 0))
+		{
+			if (x.getSize() != y.getSize())
+			{
+				throw std::invalid_argument("sizes of the arrays differ");
+			}
+			return dot(x.getPointer(), y.getPointer(), (size_t)x.getSize());
+		}
+		/**
+		 * y = alpha * x + y
+		 * @throw std::invalid_argument - if the sizes differ
+		 */
+		template<class T, size_t Alignment, class Allocator> inline void axpy(T alpha, rawVector<T, Alignment, Allocator> &x, rawVector<T, Alignment, Allocator> &y)
+		{
+			if (x.getSize() != y.getSize())
+			{
+				throw std::invalid_argument("sizes of the arrays differ");
+			}
+			axpy(alpha, x.getPointer(), y.getPointer(), (size_t)x.getSize());
+		}
+		/**
+		 * x = alpha * x
+		 */
+		template<class T, size_t Alignment, class Allocator> inline void scale(T alpha, rawVector<T, Alignment, Allocator> &x)
+		{
+			scale(alpha, x.getPointer(), (size_t)x.getSize());
+		}
+		/**
+		 * returns the smallest element
+		 * @throw std::invalid_argument - if the array is empty
+		 */
+		template<class T, size_t Alignment, class Allocator> inline T minValue(rawVector<T, Alignment, Allocator> &x)
+		{
+			return minValue(x.getPointer(), (size_t)x.getSize());
+		}
+		/**
+		 * returns the largest element
+		 * @throw std::invalid_argument - if the array is empty
+		 */
+		template<class T, size_t Alignment, class Allocator> inline T maxValue(rawVector<T, Alignment, Allocator> &x)
+		{
+			return maxValue(x.getPointer(), (size_t)x.getSize());
+		}
+		/**
+		 * out = a * b + c
+		 * @throw std::invalid_argument - if the sizes differ
+		 */
+		template<class T, size_t Alignment, class Allocator> inline void multiplyAdd(rawVector<T, Alignment, Allocator> &a, rawVector<T, Alignment, Allocator> &b, rawVector<T, Alignment, Allocator> &c, rawVector<T, Alignment, Allocator> &out)
+		{
+			if ((a.getSize() != b.getSize()) || (a.getSize() != c.getSize()) || (a.getSize() != out.getSize()))
+			{
+				throw std::invalid_argument("sizes of the arrays differ");
+			}
+			multiplyAdd(a.getPointer(), b.getPointer(), c.getPointer(), out.getPointer(), (size_t)a.getSize());
+		}
+		/**
+		 * returns the sum of all elements of the contiguous view
+		 * @throw std::invalid_argument - if the view is not contiguous
+		 */
+		template<class T> inline auto sum(rawVectorView<T> x) -> decltype(sum((const T*)NULL, 0))
+		{
+			if (!x.isContiguous())
+			{
+				throw std::invalid_argument("view must be contiguous");
+			}
+			return sum((const T*)x.getPointer(), (size_t)x.getSize());
+		}
+		/**
+		 * returns the dot product of the contiguous views
+		 * @throw std::invalid_argument - if the views are not contiguous or the sizes differ
+		 */
+		template<class T> inline auto dot(rawVectorView<T> x, rawVectorView<T> y) -> decltype(dot((const T*)NULL, (const T*)NULL, 0))
+		{
+			if (!x.isContiguous() || !y.isContiguous() || (x.getSize() != y.getSize()))
+			{
+				throw std::invalid_argument("views must be contiguous and of the same size");
+			}
+			return dot((const T*)x.getPointer(), (const T*)y.getPointer(), (size_t)x.getSize());
+		}
+		#pragma endregion
+	}
+}
+#endif
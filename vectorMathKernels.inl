@@ -0,0 +1,144 @@
+/**
+ * @brief Kernels of vectorMath.cpp
+ *
+ * This file is included once for every instruction set (inside of a "#pragma GCC target" region),
+ * so the same loops are compiled for scalar, AVX2 and AVX-512 code.
+ * The traits class S provides the vector type and the operations:
+ *   T, V, W                       - element type, vector type and number of elements per vector
+ *   R, A                          - type of sums (long long for int32_t) and of the accumulator
+ *   load, store, set1, mul, madd  - madd(a, b, c) = a * b + c
+ *   vmin, vmax, hmin, hmax        - element-wise and horizontal minimum/maximum
+ *   accZero, accAdd, accDot, accMerge, accReduce
+ *   smadd                         - scalar a * b + c with the same overflow behaviour as the vector code
+ *
+ * Licence: Released to the PUBLIC DOMAIN
+ */
+template<class S> struct kernels
+{
+	typedef typename S::T T;
+	typedef typename S::V V;
+	typedef typename S::R R;
+	typedef typename S::A A;
+
+	//four independent accumulators hide the latency of the add instructions
+	static R sum(const T *x, size_t n)
+	{
+		A a0 = S::accZero(), a1 = S::accZero(), a2 = S::accZero(), a3 = S::accZero();
+		size_t i = 0;
+		for (; i + 4 * S::W <= n; i += 4 * S::W)
+		{
+			a0 = S::accAdd(a0, S::load(x + i));
+			a1 = S::accAdd(a1, S::load(x + i + S::W));
+			a2 = S::accAdd(a2, S::load(x + i + 2 * S::W));
+			a3 = S::accAdd(a3, S::load(x + i + 3 * S::W));
+		}
+		for (; i + S::W <= n; i += S::W)
+		{
+			a0 = S::accAdd(a0, S::load(x + i));
+		}
+		R res = S::accReduce(S::accMerge(S::accMerge(a0, a1), S::accMerge(a2, a3)));
+		for (; i < n; i++)
+		{
+			res += (R)x[i];
+		}
+		return res;
+	}
+	static R dot(const T *x, const T *y, size_t n)
+	{
+		A a0 = S::accZero(), a1 = S::accZero(), a2 = S::accZero(), a3 = S::accZero();
+		size_t i = 0;
+		for (; i + 4 * S::W <= n; i += 4 * S::W)
+		{
+			a0 = S::accDot(a0, S::load(x + i), S::load(y + i));
+			a1 = S::accDot(a1, S::load(x + i + S::W), S::load(y + i + S::W));
+			a2 = S::accDot(a2, S::load(x + i + 2 * S::W), S::load(y + i + 2 * S::W));
+			a3 = S::accDot(a3, S::load(x + i + 3 * S::W), S::load(y + i + 3 * S::W));
+		}
+		for (; i + S::W <= n; i += S::W)
+		{
+			a0 = S::accDot(a0, S::load(x + i), S::load(y + i));
+		}
+		R res = S::accReduce(S::accMerge(S::accMerge(a0, a1), S::accMerge(a2, a3)));
+		for (; i < n; i++)
+		{
+			res += (R)x[i] * (R)y[i];
+		}
+		return res;
+	}
+	static void axpy(T alpha, const T *x, T *y, size_t n)
+	{
+		V va = S::set1(alpha);
+		size_t i = 0;
+		for (; i + S::W <= n; i += S::W)
+		{
+			S::store(y + i, S::madd(va, S::load(x + i), S::load(y + i)));
+		}
+		for (; i < n; i++)
+		{
+			y[i] = S::smadd(alpha, x[i], y[i]);
+		}
+	}
+	static void scale(T alpha, T *x, size_t n)
+	{
+		V va = S::set1(alpha);
+		size_t i = 0;
+		for (; i + S::W <= n; i += S::W)
+		{
+			S::store(x + i, S::mul(va, S::load(x + i)));
+		}
+		for (; i < n; i++)
+		{
+			x[i] = S::smadd(alpha, x[i], (T)0);
+		}
+	}
+	static T minValue(const T *x, size_t n)
+	{
+		size_t i = 0;
+		T res = x[0];
+		if (n >= S::W)
+		{
+			V m = S::load(x);
+			for (i = S::W; i + S::W <= n; i += S::W)
+			{
+				m = S::vmin(m, S::load(x + i));
+			}
+			res = S::hmin(m);
+		}
+		for (; i < n; i++)
+		{
+			res = (x[i] < res) ? x[i] : res;
+		}
+		return res;
+	}
+	static T maxValue(const T *x, size_t n)
+	{
+		size_t i = 0;
+		T res = x[0];
+		if (n >= S::W)
+		{
+			V m = S::load(x);
+			for (i = S::W; i + S::W <= n; i += S::W)
+			{
+				m = S::vmax(m, S::load(x + i));
+			}
+			res = S::hmax(m);
+		}
+		for (; i < n; i++)
+		{
+			res = (x[i] > res) ? x[i] : res;
+		}
+		return res;
+	}
+	static void multiplyAdd(const T *a, const T *b, const T *c, T *out, size_t n)
+	{
+		size_t i = 0;
+		for (; i + S::W <= n; i += S::W)
+		{
+			S::store(out + i, S::madd(S::load(a + i), S::load(b + i), S::load(c + i)));
+		}
+		for (; i < n; i++)
+		{
+			out[i] = S::smadd(a[i], b[i], c[i]);
+		}
+	}
+};